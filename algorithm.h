@@ -0,0 +1,196 @@
+// MIT License
+
+// graph - http://www.github/ilariom/graph
+// Copyright (c) 2020 - Ilario Mangano
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef algorithm_h
+#define algorithm_h
+
+#include "graph.h"
+#include "parallel.h"
+
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace estd
+{
+
+// Component of every node, numbered from 0 to count - 1. Erased nodes are in null_id.
+struct components
+{
+    std::vector<size_t> of;
+    size_t count = 0;
+};
+
+// Nodes connected ignoring edge direction, found by union-find over the edges.
+// Components are numbered by their lowest node id.
+template <typename T, typename V, typename A>
+components weakly_connected_components(const graph<T, V, A>& G);
+
+// Same as above, with edges processed by the given number of threads (0 is one
+// per hardware thread) through a lock-free union-find. Numbering is the same.
+template <typename T, typename V, typename A>
+components parallel_weakly_connected_components(const graph<T, V, A>& G, unsigned threads = 0);
+
+template <typename T, typename V, typename A>
+components weakly_connected_components(const graph<T, V, A>& G, execution::sequenced_policy);
+
+template <typename T, typename V, typename A>
+components weakly_connected_components(const graph<T, V, A>& G, const execution::parallel_policy& policy);
+
+// Nodes reachable from each other, found by Tarjan's algorithm with an explicit stack,
+// so deep graphs don't overflow the call stack. Components are numbered in reverse
+// topological order: edges between components go from higher to lower numbers.
+template <typename T, typename V, typename A>
+components strongly_connected_components(const graph<T, V, A>& G);
+
+// Fills order with the nodes of G so that every edge goes from an earlier node to a later one
+// (Kahn's algorithm). Returns false, leaving order empty, if G has a cycle.
+template <typename T, typename V, typename A>
+bool topological_sort(const graph<T, V, A>& G, std::vector<typename graph<T, V, A>::id_type>& order);
+
+// Shortest distances between all pairs of nodes, as a capacity() x capacity() matrix
+// stored by rows. Unreachable pairs are at std::numeric_limits<weight_type>::max().
+// When asked for, it also keeps the first hop of every shortest path.
+template <typename weight_type>
+class distance_matrix
+{
+public:
+    distance_matrix() = default;
+    distance_matrix(size_t n, bool paths);
+
+public:
+    size_t size() const { return n_; }
+    weight_type distance(size_t from, size_t to) const { return dist_[from * n_ + to]; }
+    const weight_type* row(size_t from) const { return dist_.data() + from * n_; }
+
+    // Next node after from on a shortest path to to, or null_id if there's none or
+    // paths were not computed
+    size_t next_hop(size_t from, size_t to) const { return next_.empty() ? null_id : next_[from * n_ + to]; }
+    std::vector<size_t> path(size_t from, size_t to) const;
+    bool has_paths() const { return !next_.empty(); }
+
+    // With a negative cycle, some distances are not defined, and the matrix is only partially filled
+    bool has_negative_cycle() const { return negative_cycle_; }
+
+    static constexpr const size_t null_id = std::numeric_limits<size_t>::max();
+
+private:
+    template <typename T, typename V, typename A>
+    friend distance_matrix<typename graph<T, V, A>::weight_type> floyd_warshall(const graph<T, V, A>& G, bool paths, unsigned threads);
+
+    template <typename T, typename V, typename A>
+    friend distance_matrix<typename graph<T, V, A>::weight_type> johnson(const graph<T, V, A>& G, bool paths, unsigned threads);
+
+private:
+    size_t n_ = 0;
+    std::vector<weight_type> dist_;
+    std::vector<size_t> next_;
+    bool negative_cycle_ = false;
+};
+
+// Floyd-Warshall on tiles of the matrix that fit in cache. Tiles of the same round
+// are updated by the given number of threads, and inner loops are branch free,
+// so the compiler can vectorize them (e.g. -O3, plus -mavx2 for the next hops).
+// O(n^3), for dense or small graphs.
+template <typename T, typename V, typename A>
+distance_matrix<typename graph<T, V, A>::weight_type> floyd_warshall(const graph<T, V, A>& G, bool paths = false, unsigned threads = 0);
+
+// Johnson's algorithm: one Bellman-Ford pass to make weights non-negative, when needed,
+// then a Dijkstra from every node, run by the given number of threads. O(n m log n), for sparse graphs.
+template <typename T, typename V, typename A>
+distance_matrix<typename graph<T, V, A>::weight_type> johnson(const graph<T, V, A>& G, bool paths = false, unsigned threads = 0);
+
+// Picks floyd_warshall for small or dense graphs and johnson otherwise.
+template <typename T, typename V, typename A>
+distance_matrix<typename graph<T, V, A>::weight_type> all_pairs_shortest_paths(const graph<T, V, A>& G, bool paths = false, unsigned threads = 0);
+
+// Scores of a link analysis, one per node (0 for erased nodes), with the number of
+// iterations it took and the L1 norm of the change made by the last one.
+struct ranking
+{
+    std::vector<double> score;
+    size_t iterations = 0;
+    double error = 0;
+};
+
+// PageRank by power iteration, pulling the scores of every node from in(). Iterations stop
+// when they change the scores by less than tolerance (L1 norm), or after max_iterations.
+// Scores sum up to 1, and the score of nodes without out edges goes to every node.
+// Node loops are branch free, so they can be vectorized (e.g. -O3), and split among the given
+// number of threads. Sums over in() are gathers, bound by memory latency more than by arithmetic.
+template <typename T, typename V, typename A>
+ranking pagerank(const graph<T, V, A>& G, double damping = 0.85, double tolerance = 1e-6, size_t max_iterations = 100, unsigned threads = 0);
+
+// Same as above, starting from the scores of a previous ranking, e.g. of an older version of G:
+// when few edges changed, it takes a fraction of the iterations. New nodes start from the average
+template <typename T, typename V, typename A>
+ranking pagerank(
+    const graph<T, V, A>& G,
+    const ranking& start,
+    double damping = 0.85,
+    double tolerance = 1e-6,
+    size_t max_iterations = 100,
+    unsigned threads = 0
+);
+
+// PageRank where random jumps, and the score of nodes without out edges, only go to sources.
+// Erased ids in sources are ignored, and without any valid source it's the same as pagerank.
+template <typename T, typename V, typename A>
+ranking personalized_pagerank(
+    const graph<T, V, A>& G,
+    const std::vector<typename graph<T, V, A>::id_type>& sources,
+    double damping = 0.85,
+    double tolerance = 1e-6,
+    size_t max_iterations = 100,
+    unsigned threads = 0
+);
+
+template <typename T, typename V, typename A>
+ranking personalized_pagerank(
+    const graph<T, V, A>& G,
+    const std::vector<typename graph<T, V, A>::id_type>& sources,
+    const ranking& start,
+    double damping = 0.85,
+    double tolerance = 1e-6,
+    size_t max_iterations = 100,
+    unsigned threads = 0
+);
+
+// Edges of every node, in and out, over the number of other nodes.
+template <typename T, typename V, typename A>
+std::vector<double> degree_centrality(const graph<T, V, A>& G);
+
+// How close every node is to the nodes that reach it: (r - 1)^2 / ((n - 1) * d), where r is
+// the number of nodes that reach it, itself included, and d the sum of their distances to it
+// (Wasserman and Faust), so that scores stay comparable in disconnected graphs.
+// Distances are hops for unweighted graphs, and weights, that must not be negative, otherwise.
+// One search per node over in(), run by the given number of threads. O(n m log n).
+template <typename T, typename V, typename A>
+std::vector<double> closeness_centrality(const graph<T, V, A>& G, unsigned threads = 0);
+
+#include "algorithm.inl"
+
+} // namespace estd
+
+#endif /* algorithm_h */
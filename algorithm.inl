@@ -0,0 +1,972 @@
+namespace union_find
+{
+
+inline size_t find(std::vector<size_t>& parent, size_t node)
+{
+    while (parent[node] != node)
+    {
+        parent[node] = parent[parent[node]];
+        node = parent[node];
+    }
+
+    return node;
+}
+
+// Roots are hooked under the lower id, so the root of every set is its lowest node.
+inline void unite(std::vector<size_t>& parent, size_t a, size_t b)
+{
+    a = find(parent, a);
+    b = find(parent, b);
+
+    if (a != b)
+    {
+        parent[std::max(a, b)] = std::min(a, b);
+    }
+}
+
+inline size_t find(std::vector<std::atomic<size_t>>& parent, size_t node)
+{
+    size_t p = parent[node].load(std::memory_order_relaxed);
+
+    while (p != node)
+    {
+        // Halving only moves a node closer to its root, so racing stores are harmless
+        size_t gp = parent[p].load(std::memory_order_relaxed);
+        parent[node].store(gp, std::memory_order_relaxed);
+        node = gp;
+        p = parent[node].load(std::memory_order_relaxed);
+    }
+
+    return node;
+}
+
+inline void unite(std::vector<std::atomic<size_t>>& parent, size_t a, size_t b)
+{
+    while (true)
+    {
+        a = find(parent, a);
+        b = find(parent, b);
+
+        if (a == b)
+        {
+            return;
+        }
+
+        if (a < b)
+        {
+            std::swap(a, b);
+        }
+
+        // a is only hooked if it's still a root, otherwise someone else got there first
+        size_t expected = a;
+
+        if (parent[a].compare_exchange_weak(expected, b, std::memory_order_relaxed))
+        {
+            return;
+        }
+    }
+}
+
+// Numbers the sets by increasing root, skipping erased nodes.
+template <typename graph_type, typename root_function>
+inline components label(const graph_type& G, root_function root_of)
+{
+    components c;
+    c.of.assign(G.capacity(), graph_type::null_id);
+
+    for (size_t node = 0; node < G.capacity(); ++node)
+    {
+        if (!G.is_valid(node))
+        {
+            continue;
+        }
+
+        size_t root = root_of(node);
+        c.of[node] = root == node ? c.count++ : c.of[root];
+    }
+
+    return c;
+}
+
+} // namespace union_find
+
+template <typename T, typename V, typename A>
+inline components weakly_connected_components(const graph<T, V, A>& G)
+{
+    std::vector<size_t> parent(G.capacity());
+
+    for (size_t node = 0; node < parent.size(); ++node)
+    {
+        parent[node] = node;
+    }
+
+    for (size_t node = 0; node < parent.size(); ++node)
+    {
+        for (size_t child : G.out(node))
+        {
+            union_find::unite(parent, node, child);
+        }
+    }
+
+    return union_find::label(G, [&parent] (size_t node) { return union_find::find(parent, node); });
+}
+
+template <typename T, typename V, typename A>
+inline components parallel_weakly_connected_components(const graph<T, V, A>& G, unsigned threads)
+{
+    const size_t grain = 1024;
+    size_t n = G.capacity();
+    std::vector<std::atomic<size_t>> parent(n);
+
+    threads = execution::concurrency(threads);
+
+    execution::parallel_for(threads, n, 4096, [&parent] (size_t first, size_t last, unsigned) {
+        for (size_t node = first; node < last; ++node)
+        {
+            parent[node].store(node, std::memory_order_relaxed);
+        }
+    });
+
+    execution::parallel_for(threads, n, grain, [&G, &parent] (size_t first, size_t last, unsigned) {
+        for (size_t node = first; node < last; ++node)
+        {
+            for (size_t child : G.out(node))
+            {
+                union_find::unite(parent, node, child);
+            }
+        }
+    });
+
+    // After the flattening every node points straight to its root
+    execution::parallel_for(threads, n, 4096, [&parent] (size_t first, size_t last, unsigned) {
+        for (size_t node = first; node < last; ++node)
+        {
+            parent[node].store(union_find::find(parent, node), std::memory_order_relaxed);
+        }
+    });
+
+    return union_find::label(G, [&parent] (size_t node) { return parent[node].load(std::memory_order_relaxed); });
+}
+
+template <typename T, typename V, typename A>
+inline components weakly_connected_components(const graph<T, V, A>& G, execution::sequenced_policy)
+{
+    return weakly_connected_components(G);
+}
+
+template <typename T, typename V, typename A>
+inline components weakly_connected_components(const graph<T, V, A>& G, const execution::parallel_policy& policy)
+{
+    return parallel_weakly_connected_components(G, policy.threads);
+}
+
+template <typename T, typename V, typename A>
+inline components strongly_connected_components(const graph<T, V, A>& G)
+{
+    using id_type = typename graph<T, V, A>::id_type;
+
+    const id_type null_id = graph<T, V, A>::null_id;
+
+    // Frames of the depth first visit: the node and the next of its children to look at
+    struct frame
+    {
+        id_type node;
+        size_t next;
+    };
+
+    size_t n = G.capacity();
+    std::vector<id_type> index(n, null_id);
+    std::vector<id_type> low(n, null_id);
+    std::vector<id_type> stack;
+    std::vector<frame> frames;
+    id_type counter = 0;
+
+    components c;
+    c.of.assign(n, null_id);
+
+    auto open = [&] (id_type node) {
+        index[node] = low[node] = counter++;
+        stack.push_back(node);
+        frames.push_back({ node, 0 });
+    };
+
+    for (auto it = G.nodes_begin(); it != G.nodes_end(); ++it)
+    {
+        if (index[*it] != null_id)
+        {
+            continue;
+        }
+
+        open(*it);
+
+        while (!frames.empty())
+        {
+            frame& f = frames.back();
+            id_type node = f.node;
+
+            if (f.next < G.out(node).size())
+            {
+                id_type child = G.out(node)[f.next++];
+
+                if (index[child] == null_id)
+                {
+                    open(child);
+                }
+                else if (c.of[child] == null_id)
+                {
+                    // Still on the stack, as nodes leave it only when their component is labelled
+                    low[node] = std::min(low[node], index[child]);
+                }
+
+                continue;
+            }
+
+            frames.pop_back();
+
+            if (!frames.empty())
+            {
+                id_type parent = frames.back().node;
+                low[parent] = std::min(low[parent], low[node]);
+            }
+
+            if (low[node] != index[node])
+            {
+                continue;
+            }
+
+            id_type member;
+
+            do
+            {
+                member = stack.back();
+                stack.pop_back();
+                c.of[member] = c.count;
+            }
+            while (member != node);
+
+            c.count++;
+        }
+    }
+
+    return c;
+}
+
+template <typename T, typename V, typename A>
+inline bool topological_sort(const graph<T, V, A>& G, std::vector<typename graph<T, V, A>::id_type>& order)
+{
+    using id_type = typename graph<T, V, A>::id_type;
+
+    std::vector<size_t> in_degree(G.capacity(), 0);
+
+    order.clear();
+    order.reserve(G.order());
+
+    for (auto it = G.nodes_begin(); it != G.nodes_end(); ++it)
+    {
+        in_degree[*it] = G.in(*it).size();
+
+        if (in_degree[*it] == 0)
+        {
+            order.push_back(*it);
+        }
+    }
+
+    for (size_t head = 0; head < order.size(); ++head)
+    {
+        for (id_type child : G.out(order[head]))
+        {
+            if (--in_degree[child] == 0)
+            {
+                order.push_back(child);
+            }
+        }
+    }
+
+    if (order.size() != G.order())
+    {
+        order.clear();
+        return false;
+    }
+
+    return true;
+}
+
+template <typename weight_type>
+constexpr const size_t distance_matrix<weight_type>::null_id;
+
+template <typename weight_type>
+inline distance_matrix<weight_type>::distance_matrix(size_t n, bool paths)
+    : n_(n), dist_(n * n, std::numeric_limits<weight_type>::max())
+{
+    if (paths)
+    {
+        next_.assign(n * n, null_id);
+    }
+}
+
+template <typename weight_type>
+inline std::vector<size_t> distance_matrix<weight_type>::path(size_t from, size_t to) const
+{
+    std::vector<size_t> nodes;
+
+    if (next_hop(from, to) == null_id)
+    {
+        return nodes;
+    }
+
+    nodes.push_back(from);
+
+    while (from != to && nodes.size() <= n_)
+    {
+        from = next_hop(from, to);
+        nodes.push_back(from);
+    }
+
+    return nodes;
+}
+
+namespace apsp
+{
+
+// Side of the square tiles: three of them fit in L2 for any weight type up to 8 bytes
+constexpr size_t tile = 64;
+
+// Relaxes the tile at rows [i0, i1) and columns [j0, j1) through the nodes in [k0, k1).
+// Row k is copied to the stack, so the compiler knows it can't alias the rows being
+// updated, and additions are only used where they can't overflow, selected otherwise.
+// Row k itself never changes, as long as there are no negative cycles.
+template <typename weight_type>
+inline void relax_tile(weight_type* D, size_t* next, size_t n, size_t i0, size_t i1, size_t j0, size_t j1, size_t k0, size_t k1)
+{
+    const weight_type inf = std::numeric_limits<weight_type>::max();
+    const size_t width = j1 - j0;
+    weight_type row_k[tile];
+
+    for (size_t k = k0; k < k1; ++k)
+    {
+        for (size_t j = 0; j < width; ++j)
+        {
+            row_k[j] = D[k * n + j0 + j];
+        }
+
+        for (size_t i = i0; i < i1; ++i)
+        {
+            weight_type* row_i = D + i * n + j0;
+            weight_type dik = D[i * n + k];
+
+            if (dik == inf || i == k)
+            {
+                continue;
+            }
+
+            if (next == nullptr)
+            {
+                for (size_t j = 0; j < width; ++j)
+                {
+                    weight_type through = row_k[j] == inf ? inf : dik + row_k[j];
+                    row_i[j] = through < row_i[j] ? through : row_i[j];
+                }
+
+                continue;
+            }
+
+            size_t* next_i = next + i * n + j0;
+            size_t hop = next[i * n + k];
+
+            for (size_t j = 0; j < width; ++j)
+            {
+                weight_type through = row_k[j] == inf ? inf : dik + row_k[j];
+                size_t shorter = through < row_i[j] ? ~size_t { 0 } : 0;
+                row_i[j] = through < row_i[j] ? through : row_i[j];
+                next_i[j] = (hop & shorter) | (next_i[j] & ~shorter);
+            }
+        }
+    }
+}
+
+} // namespace apsp
+
+template <typename T, typename V, typename A>
+inline distance_matrix<typename graph<T, V, A>::weight_type> floyd_warshall(const graph<T, V, A>& G, bool paths, unsigned threads)
+{
+    using weight_type = typename graph<T, V, A>::weight_type;
+    using id_type = typename graph<T, V, A>::id_type;
+
+    const size_t tile = apsp::tile;
+    size_t n = G.capacity();
+    distance_matrix<weight_type> M { n, paths };
+    weight_type* D = M.dist_.data();
+    size_t* next = paths ? M.next_.data() : nullptr;
+
+    for (auto it = G.nodes_begin(); it != G.nodes_end(); ++it)
+    {
+        id_type u = *it;
+        D[u * n + u] = 0;
+
+        if (paths)
+        {
+            next[u * n + u] = u;
+        }
+
+        for (auto e : G.out_edges(u))
+        {
+            if (e.second < D[u * n + e.first])
+            {
+                D[u * n + e.first] = e.second;
+
+                if (paths)
+                {
+                    next[u * n + e.first] = e.first;
+                }
+            }
+        }
+    }
+
+    threads = execution::concurrency(threads);
+    size_t tiles = (n + tile - 1) / tile;
+
+    for (size_t kt = 0; kt < tiles; ++kt)
+    {
+        size_t k0 = kt * tile;
+        size_t k1 = std::min(n, k0 + tile);
+
+        // Diagonal tile first, then the tiles in its row and column, then all the others
+        apsp::relax_tile(D, next, n, k0, k1, k0, k1, k0, k1);
+
+        execution::parallel_for(threads, tiles, 1, [&] (size_t first, size_t last, unsigned) {
+            for (size_t t = first; t < last; ++t)
+            {
+                if (t != kt)
+                {
+                    apsp::relax_tile(D, next, n, k0, k1, t * tile, std::min(n, (t + 1) * tile), k0, k1);
+                    apsp::relax_tile(D, next, n, t * tile, std::min(n, (t + 1) * tile), k0, k1, k0, k1);
+                }
+            }
+        });
+
+        execution::parallel_for(threads, tiles * tiles, 1, [&] (size_t first, size_t last, unsigned) {
+            for (size_t t = first; t < last; ++t)
+            {
+                size_t it = t / tiles;
+                size_t jt = t % tiles;
+
+                if (it != kt && jt != kt)
+                {
+                    apsp::relax_tile(D, next, n, it * tile, std::min(n, (it + 1) * tile), jt * tile, std::min(n, (jt + 1) * tile), k0, k1);
+                }
+            }
+        });
+    }
+
+    for (id_type u = 0; u < n; ++u)
+    {
+        M.negative_cycle_ = M.negative_cycle_ || D[u * n + u] < 0;
+    }
+
+    return M;
+}
+
+template <typename T, typename V, typename A>
+inline distance_matrix<typename graph<T, V, A>::weight_type> johnson(const graph<T, V, A>& G, bool paths, unsigned threads)
+{
+    using weight_type = typename graph<T, V, A>::weight_type;
+    using id_type = typename graph<T, V, A>::id_type;
+
+    const weight_type inf = std::numeric_limits<weight_type>::max();
+    const id_type null_id = graph<T, V, A>::null_id;
+    size_t n = G.capacity();
+    distance_matrix<weight_type> M { n, paths };
+
+    // Potentials from a virtual source with a zero weight edge to every node
+    std::vector<weight_type> h(n, 0);
+
+    if (G.has_negative_weights())
+    {
+        bool changed = true;
+
+        for (size_t pass = 0; changed && pass <= G.order(); ++pass)
+        {
+            changed = false;
+
+            for (auto it = G.nodes_begin(); it != G.nodes_end(); ++it)
+            {
+                for (auto e : G.out_edges(*it))
+                {
+                    if (h[*it] + e.second < h[e.first])
+                    {
+                        h[e.first] = h[*it] + e.second;
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        if (changed)
+        {
+            M.negative_cycle_ = true;
+            return M;
+        }
+    }
+
+    struct thread_state
+    {
+        std::vector<weight_type> d;
+        std::vector<id_type> first;
+        std::vector<id_type> settled;
+    };
+
+    threads = execution::concurrency(threads);
+    std::vector<thread_state> states(threads);
+
+    execution::parallel_for(threads, n, 1, [&] (size_t begin, size_t end, unsigned idx) {
+        thread_state& state = states[idx];
+
+        // Every source puts back the entries it touched, so the arrays are only filled once per thread
+        if (state.d.size() != n)
+        {
+            state.d.assign(n, inf);
+            state.first.assign(n, null_id);
+        }
+
+        for (id_type source = begin; source < end; ++source)
+        {
+            if (!G.is_valid(source))
+            {
+                continue;
+            }
+
+            std::vector<weight_type>& d = state.d;
+            std::vector<id_type>& first = state.first;
+            std::vector<id_type>& settled = state.settled;
+            typename heap::preferred<weight_type>::template queue<weight_type, id_type> Q;
+
+            settled.clear();
+            d[source] = 0;
+            first[source] = source;
+            Q.push(0, source);
+
+            while (!Q.empty())
+            {
+                weight_type du = Q.top().first;
+                id_type u = Q.top().second;
+                Q.pop();
+
+                if (d[u] < du)
+                {
+                    continue;
+                }
+
+                settled.push_back(u);
+
+                for (auto e : G.out_edges(u))
+                {
+                    weight_type dv = du + e.second + h[u] - h[e.first];
+
+                    if (dv < d[e.first])
+                    {
+                        d[e.first] = dv;
+                        first[e.first] = u == source ? e.first : first[u];
+                        Q.push(dv, e.first);
+                    }
+                }
+            }
+
+            weight_type* row = M.dist_.data() + source * n;
+            size_t* next = paths ? M.next_.data() + source * n : nullptr;
+
+            for (id_type v : settled)
+            {
+                row[v] = d[v] - h[source] + h[v];
+
+                if (next != nullptr)
+                {
+                    next[v] = first[v];
+                }
+
+                d[v] = inf;
+                first[v] = null_id;
+            }
+        }
+    });
+
+    return M;
+}
+
+template <typename T, typename V, typename A>
+inline distance_matrix<typename graph<T, V, A>::weight_type> all_pairs_shortest_paths(const graph<T, V, A>& G, bool paths, unsigned threads)
+{
+    size_t n = G.capacity();
+
+    if (n <= 2 * apsp::tile || G.size() >= n * n / 32)
+    {
+        return floyd_warshall(G, paths, threads);
+    }
+
+    return johnson(G, paths, threads);
+}
+
+namespace link_analysis
+{
+
+const size_t grain = 4096;
+
+// Scores to start from: those of start where there are, the average for new nodes, scaled to sum up to 1
+template <typename T, typename V, typename A>
+inline std::vector<double> initial_scores(const graph<T, V, A>& G, const ranking* start)
+{
+    size_t n = G.capacity();
+    double average = G.order() > 0 ? 1.0 / G.order() : 0;
+    std::vector<double> x(n, 0);
+    double total = 0;
+
+    for (auto it = G.nodes_begin(); it != G.nodes_end(); ++it)
+    {
+        x[*it] = start != nullptr && *it < start->score.size() ? start->score[*it] : average;
+        total += x[*it];
+    }
+
+    if (!(total > 0))
+    {
+        for (auto it = G.nodes_begin(); it != G.nodes_end(); ++it)
+        {
+            x[*it] = average;
+        }
+
+        return x;
+    }
+
+    for (double& score : x)
+    {
+        score /= total;
+    }
+
+    return x;
+}
+
+// Power iteration from scores x, where random jumps land as teleport says. Both sum up to 1.
+template <typename T, typename V, typename A>
+inline ranking power_iteration(
+    const graph<T, V, A>& G,
+    std::vector<double> x,
+    const std::vector<double>& teleport,
+    double damping,
+    double tolerance,
+    size_t max_iterations,
+    unsigned threads
+)
+{
+    using id_type = typename graph<T, V, A>::id_type;
+
+    struct partial
+    {
+        double dangling = 0;
+        double error = 0;
+    };
+
+    threads = execution::concurrency(threads);
+    size_t n = G.capacity();
+
+    // Multiplying by inv, 1 over the out degree, and by dangling, 1 for the nodes
+    // without out edges, keeps node loops free of branches
+    std::vector<double> inv(n);
+    std::vector<double> dangling(n);
+    std::vector<double> contrib(n);
+    std::vector<double> y(n);
+    std::vector<execution::cache_padded<partial>> partials(threads);
+    ranking R;
+
+    execution::parallel_for(threads, n, grain, [&] (size_t first, size_t last, unsigned) {
+        for (id_type u = first; u < last; ++u)
+        {
+            size_t degree = G.out(u).size();
+            inv[u] = degree > 0 ? 1.0 / degree : 0;
+            dangling[u] = degree == 0 && G.is_valid(u) ? 1 : 0;
+        }
+    });
+
+    while (R.iterations < max_iterations)
+    {
+        for (partial& p : partials)
+        {
+            p.dangling = 0;
+            p.error = 0;
+        }
+
+        execution::parallel_for(threads, n, grain, [&] (size_t first, size_t last, unsigned idx) {
+            double lost = 0;
+
+            for (size_t u = first; u < last; ++u)
+            {
+                contrib[u] = x[u] * inv[u];
+                lost += x[u] * dangling[u];
+            }
+
+            partials[idx].dangling += lost;
+        });
+
+        double lost = 0;
+
+        for (const partial& p : partials)
+        {
+            lost += p.dangling;
+        }
+
+        // Random jumps, plus the score of nodes without out edges
+        double jump = 1 - damping + damping * lost;
+
+        execution::parallel_for(threads, n, grain, [&] (size_t first, size_t last, unsigned idx) {
+            double error = 0;
+
+            for (size_t v = first; v < last; ++v)
+            {
+                const id_type* parents = G.in(v).data();
+                size_t k = G.in(v).size();
+                double sum = 0;
+
+                for (size_t i = 0; i < k; ++i)
+                {
+                    sum += contrib[parents[i]];
+                }
+
+                y[v] = damping * sum + jump * teleport[v];
+                error += std::abs(y[v] - x[v]);
+            }
+
+            partials[idx].error += error;
+        });
+
+        R.error = 0;
+
+        for (const partial& p : partials)
+        {
+            R.error += p.error;
+        }
+
+        x.swap(y);
+        R.iterations++;
+
+        if (R.error < tolerance)
+        {
+            break;
+        }
+    }
+
+    R.score = std::move(x);
+
+    return R;
+}
+
+template <typename T, typename V, typename A>
+inline std::vector<double> personal_teleport(const graph<T, V, A>& G, const std::vector<typename graph<T, V, A>::id_type>& sources)
+{
+    std::vector<double> teleport(G.capacity(), 0);
+    size_t count = 0;
+
+    for (auto source : sources)
+    {
+        count += G.is_valid(source) ? 1 : 0;
+    }
+
+    // With no sources to jump to, jumps go anywhere, as in pagerank
+    if (count == 0)
+    {
+        return initial_scores(G, nullptr);
+    }
+
+    for (auto source : sources)
+    {
+        if (G.is_valid(source))
+        {
+            teleport[source] += 1.0 / count;
+        }
+    }
+
+    return teleport;
+}
+
+} // namespace link_analysis
+
+template <typename T, typename V, typename A>
+inline ranking pagerank(const graph<T, V, A>& G, double damping, double tolerance, size_t max_iterations, unsigned threads)
+{
+    std::vector<double> teleport = link_analysis::initial_scores(G, nullptr);
+    return link_analysis::power_iteration(G, teleport, teleport, damping, tolerance, max_iterations, threads);
+}
+
+template <typename T, typename V, typename A>
+inline ranking pagerank(
+    const graph<T, V, A>& G,
+    const ranking& start,
+    double damping,
+    double tolerance,
+    size_t max_iterations,
+    unsigned threads
+)
+{
+    return link_analysis::power_iteration(
+        G,
+        link_analysis::initial_scores(G, &start),
+        link_analysis::initial_scores(G, nullptr),
+        damping, tolerance, max_iterations, threads
+    );
+}
+
+template <typename T, typename V, typename A>
+inline ranking personalized_pagerank(
+    const graph<T, V, A>& G,
+    const std::vector<typename graph<T, V, A>::id_type>& sources,
+    double damping,
+    double tolerance,
+    size_t max_iterations,
+    unsigned threads
+)
+{
+    std::vector<double> teleport = link_analysis::personal_teleport(G, sources);
+    return link_analysis::power_iteration(G, teleport, teleport, damping, tolerance, max_iterations, threads);
+}
+
+template <typename T, typename V, typename A>
+inline ranking personalized_pagerank(
+    const graph<T, V, A>& G,
+    const std::vector<typename graph<T, V, A>::id_type>& sources,
+    const ranking& start,
+    double damping,
+    double tolerance,
+    size_t max_iterations,
+    unsigned threads
+)
+{
+    return link_analysis::power_iteration(
+        G,
+        link_analysis::initial_scores(G, &start),
+        link_analysis::personal_teleport(G, sources),
+        damping, tolerance, max_iterations, threads
+    );
+}
+
+template <typename T, typename V, typename A>
+inline std::vector<double> degree_centrality(const graph<T, V, A>& G)
+{
+    std::vector<double> score(G.capacity(), 0);
+
+    if (G.order() < 2)
+    {
+        return score;
+    }
+
+    for (auto it = G.nodes_begin(); it != G.nodes_end(); ++it)
+    {
+        score[*it] = static_cast<double>(G.in(*it).size() + G.out(*it).size()) / (G.order() - 1);
+    }
+
+    return score;
+}
+
+template <typename T, typename V, typename A>
+inline std::vector<double> closeness_centrality(const graph<T, V, A>& G, unsigned threads)
+{
+    using weight_type = typename graph<T, V, A>::weight_type;
+    using id_type = typename graph<T, V, A>::id_type;
+
+    const weight_type inf = std::numeric_limits<weight_type>::max();
+    size_t n = G.capacity();
+    std::vector<double> score(n, 0);
+
+    if (G.order() < 2)
+    {
+        return score;
+    }
+
+    struct thread_state
+    {
+        std::vector<weight_type> d;
+        std::vector<id_type> reached;
+    };
+
+    threads = execution::concurrency(threads);
+    std::vector<thread_state> states(threads);
+
+    execution::parallel_for(threads, n, 64, [&] (size_t begin, size_t end, unsigned idx) {
+        thread_state& state = states[idx];
+        std::vector<weight_type>& d = state.d;
+        std::vector<id_type>& reached = state.reached;
+
+        if (d.size() != n)
+        {
+            d.assign(n, inf);
+        }
+
+        for (id_type target = begin; target < end; ++target)
+        {
+            if (!G.is_valid(target))
+            {
+                continue;
+            }
+
+            reached.clear();
+            reached.push_back(target);
+            d[target] = 0;
+
+            if (!G.is_weighted())
+            {
+                for (size_t head = 0; head < reached.size(); ++head)
+                {
+                    id_type v = reached[head];
+
+                    for (id_type u : G.in(v))
+                    {
+                        if (d[u] == inf)
+                        {
+                            d[u] = d[v] + 1;
+                            reached.push_back(u);
+                        }
+                    }
+                }
+            }
+            else
+            {
+                typename heap::preferred<weight_type>::template queue<weight_type, id_type> Q;
+                Q.push(0, target);
+                reached.clear();
+
+                while (!Q.empty())
+                {
+                    weight_type dv = Q.top().first;
+                    id_type v = Q.top().second;
+                    Q.pop();
+
+                    if (d[v] < dv)
+                    {
+                        continue;
+                    }
+
+                    reached.push_back(v);
+
+                    for (auto e : G.in_edges(v))
+                    {
+                        weight_type du = dv + e.second;
+
+                        if (du < d[e.first])
+                        {
+                            d[e.first] = du;
+                            Q.push(du, e.first);
+                        }
+                    }
+                }
+            }
+
+            double total = 0;
+
+            for (id_type u : reached)
+            {
+                total += static_cast<double>(d[u]);
+                d[u] = inf;
+            }
+
+            double r = static_cast<double>(reached.size() - 1);
+            score[target] = total > 0 ? r * r / ((G.order() - 1) * total) : 0;
+        }
+    });
+
+    return score;
+}
@@ -0,0 +1,129 @@
+// Monotonic memory resource. Allocations bump a pointer through large blocks
+// and are never freed one by one: everything goes away at once on release(),
+// or is reused after rewind(), so a short-lived graph costs a handful of mallocs.
+class arena
+{
+public:
+    explicit arena(size_t block_size = 64 * 1024)
+        : block_size_(block_size)
+    { }
+
+    arena(const arena&) = delete;
+    arena& operator=(const arena&) = delete;
+
+    ~arena() { release(); }
+
+public:
+    void* allocate(size_t bytes, size_t alignment);
+
+    // Makes all the memory available again, keeping the blocks for the next user.
+    // Whatever was allocated before must not be used anymore.
+    void rewind();
+
+    // Gives the blocks back to the heap.
+    void release();
+
+    size_t allocated() const { return allocated_; }
+    size_t reserved() const { return reserved_; }
+
+private:
+    struct block
+    {
+        char* data;
+        size_t size;
+    };
+
+private:
+    std::vector<block> blocks_;
+    size_t current_ = 0;
+    size_t offset_ = 0;
+    size_t block_size_;
+    size_t allocated_ = 0;
+    size_t reserved_ = 0;
+};
+
+inline void* arena::allocate(size_t bytes, size_t alignment)
+{
+    auto fit = [bytes, alignment] (const block& b, size_t offset) -> size_t {
+        size_t misalignment = reinterpret_cast<uintptr_t>(b.data + offset) % alignment;
+        size_t start = offset + (misalignment > 0 ? alignment - misalignment : 0);
+
+        return start <= b.size && bytes <= b.size - start ? start : b.size + 1;
+    };
+
+    for (; current_ < blocks_.size(); ++current_, offset_ = 0)
+    {
+        size_t start = fit(blocks_[current_], offset_);
+
+        if (start <= blocks_[current_].size)
+        {
+            offset_ = start + bytes;
+            allocated_ += bytes;
+
+            return blocks_[current_].data + start;
+        }
+    }
+
+    size_t size = std::max(block_size_, bytes + alignment);
+    blocks_.push_back({ static_cast<char*>(::operator new(size)), size });
+    reserved_ += size;
+    offset_ = 0;
+
+    size_t start = fit(blocks_.back(), 0);
+    offset_ = start + bytes;
+    allocated_ += bytes;
+
+    return blocks_.back().data + start;
+}
+
+inline void arena::rewind()
+{
+    current_ = 0;
+    offset_ = 0;
+    allocated_ = 0;
+}
+
+inline void arena::release()
+{
+    for (const block& b : blocks_)
+    {
+        ::operator delete(b.data);
+    }
+
+    blocks_.clear();
+    rewind();
+    reserved_ = 0;
+}
+
+// Allocator handing out memory from an arena. Deallocation does nothing,
+// memory is reclaimed when the arena is rewound or released.
+template <typename U>
+class arena_allocator
+{
+public:
+    using value_type = U;
+
+public:
+    arena_allocator(arena& a)
+        : arena_(&a)
+    { }
+
+    template <typename W>
+    arena_allocator(const arena_allocator<W>& other)
+        : arena_(other.resource())
+    { }
+
+public:
+    U* allocate(size_t n) { return static_cast<U*>(arena_->allocate(n * sizeof(U), alignof(U))); }
+    void deallocate(U*, size_t) { }
+    arena* resource() const { return arena_; }
+
+    template <typename W>
+    bool operator==(const arena_allocator<W>& other) const { return arena_ == other.resource(); }
+
+    template <typename W>
+    bool operator!=(const arena_allocator<W>& other) const { return !(*this == other); }
+
+private:
+    arena* arena_;
+};
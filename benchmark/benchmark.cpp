@@ -0,0 +1,487 @@
+// MIT License
+
+// graph - http://www.github/ilariom/graph
+// Copyright (c) 2020 - Ilario Mangano
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Benchmarks of the core graph operations on synthetic graphs.
+// Build and run from the repository root:
+//
+//     g++ -std=c++11 -O2 -pthread -I. benchmark/benchmark.cpp -o graph_benchmark
+//     ./graph_benchmark [--scale N] [--seed N] [--filter substring] > results.json
+//
+// Results are printed as JSON: one entry per benchmark and graph, with
+// throughput, latency percentiles and the peak resident memory so far.
+
+#include "graph.h"
+#include "algorithm.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+
+using weight_type = ssize_t;
+using graph_type = estd::weighted_digraph<int, weight_type>;
+using edge_list = std::vector<std::tuple<size_t, size_t, weight_type>>;
+using clock_type = std::chrono::steady_clock;
+
+struct workload
+{
+    std::string name;
+    size_t nodes;
+    edge_list edges;
+};
+
+struct result
+{
+    std::string name;
+    std::string graph;
+    size_t ops;
+    double seconds;
+    std::vector<double> latencies;
+    long peak_rss_kb;
+};
+
+long peak_rss_kb()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return 0;
+#endif
+}
+
+weight_type random_weight(std::mt19937_64& rng) { return 1 + rng() % 100; }
+
+// Uniform random graph with n nodes and m edges
+workload erdos_renyi(size_t n, size_t m, std::mt19937_64& rng)
+{
+    workload w { "erdos_renyi", n, {} };
+    w.edges.reserve(m);
+
+    for (size_t idx = 0; idx < m; ++idx)
+    {
+        w.edges.emplace_back(rng() % n, rng() % n, random_weight(rng));
+    }
+
+    return w;
+}
+
+// Power law graph: every edge falls recursively in one of the four quadrants
+// of the adjacency matrix, with probabilities a, b, c and 1 - a - b - c
+workload rmat(size_t scale, size_t m, std::mt19937_64& rng, double a = 0.57, double b = 0.19, double c = 0.19)
+{
+    workload w { "rmat", size_t { 1 } << scale, {} };
+    std::uniform_real_distribution<double> coin { 0, 1 };
+
+    w.edges.reserve(m);
+
+    for (size_t idx = 0; idx < m; ++idx)
+    {
+        size_t u = 0;
+        size_t v = 0;
+
+        for (size_t bit = 0; bit < scale; ++bit)
+        {
+            double p = coin(rng);
+            u = (u << 1) | (p >= a + b ? 1 : 0);
+            v = (v << 1) | ((p >= a && p < a + b) || p >= a + b + c ? 1 : 0);
+        }
+
+        w.edges.emplace_back(u, v, random_weight(rng));
+    }
+
+    return w;
+}
+
+// Two dimensional grid with edges in both directions
+workload grid(size_t side, std::mt19937_64& rng)
+{
+    workload w { "grid", side * side, {} };
+    w.edges.reserve(4 * side * side);
+
+    for (size_t r = 0; r < side; ++r)
+    {
+        for (size_t c = 0; c < side; ++c)
+        {
+            size_t node = r * side + c;
+
+            if (c + 1 < side)
+            {
+                w.edges.emplace_back(node, node + 1, random_weight(rng));
+                w.edges.emplace_back(node + 1, node, random_weight(rng));
+            }
+
+            if (r + 1 < side)
+            {
+                w.edges.emplace_back(node, node + side, random_weight(rng));
+                w.edges.emplace_back(node + side, node, random_weight(rng));
+            }
+        }
+    }
+
+    return w;
+}
+
+// Random tree that is mostly a long path, with short side branches
+workload deep_tree(size_t n, std::mt19937_64& rng)
+{
+    workload w { "deep_tree", n, {} };
+    w.edges.reserve(n);
+
+    for (size_t node = 1; node < n; ++node)
+    {
+        size_t parent = rng() % 8 == 0 && node > 16 ? node - 1 - rng() % 16 : node - 1;
+        w.edges.emplace_back(parent, node, random_weight(rng));
+    }
+
+    return w;
+}
+
+graph_type build(const workload& w)
+{
+    graph_type G;
+    std::vector<int> values(w.nodes, 0);
+
+    G.insert(values.begin(), values.end());
+    G.insert_edges(w.edges.begin(), w.edges.end());
+
+    return G;
+}
+
+// Runs fn(sample) samples times, each performing ops_per_sample operations,
+// and records the latency of a single operation for every sample
+result measure(const std::string& name, const workload& w, size_t samples, size_t ops_per_sample, const std::function<void(size_t)>& fn)
+{
+    result r { name, w.name, samples * ops_per_sample, 0, {}, 0 };
+    r.latencies.reserve(samples);
+
+    for (size_t sample = 0; sample < samples; ++sample)
+    {
+        auto start = clock_type::now();
+        fn(sample);
+        double ns = std::chrono::duration<double, std::nano>(clock_type::now() - start).count();
+
+        r.seconds += ns * 1e-9;
+        r.latencies.push_back(ns / ops_per_sample);
+    }
+
+    r.peak_rss_kb = peak_rss_kb();
+    return r;
+}
+
+double percentile(std::vector<double> values, double p)
+{
+    if (values.empty())
+    {
+        return 0;
+    }
+
+    size_t idx = static_cast<size_t>(p * (values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + idx, values.end());
+
+    return values[idx];
+}
+
+// Keeps the compiler from dropping the work being measured
+volatile size_t sink = 0;
+
+template <typename search_algorithm>
+size_t visit(const graph_type& G, size_t root)
+{
+    size_t count = 0;
+
+    for (auto it = G.begin<search_algorithm>(root); it != G.end<search_algorithm>(); ++it)
+    {
+        count++;
+    }
+
+    return count;
+}
+
+void run(const workload& w, std::mt19937_64& rng, const std::string& filter, std::vector<result>& results)
+{
+    auto enabled = [&filter] (const std::string& name) { return filter.empty() || name.find(filter) != std::string::npos; };
+    auto add = [&] (const std::string& name, size_t samples, size_t ops_per_sample, const std::function<void(size_t)>& fn) {
+        if (enabled(name))
+        {
+            results.push_back(measure(name, w, samples, ops_per_sample, fn));
+        }
+    };
+
+    const size_t batch = 1024;
+    size_t n = w.nodes;
+    size_t m = w.edges.size();
+
+    add("insert", (n + batch - 1) / batch, batch, [&] (size_t) {
+        graph_type G;
+
+        for (size_t idx = 0; idx < batch; ++idx)
+        {
+            G.insert(static_cast<int>(idx));
+        }
+
+        sink = sink + G.order();
+    });
+
+    {
+        graph_type G;
+
+        for (size_t idx = 0; idx < n; ++idx)
+        {
+            G.insert(0);
+        }
+
+        add("edge", (m + batch - 1) / batch, batch, [&] (size_t sample) {
+            size_t last = std::min(m, (sample + 1) * batch);
+
+            for (size_t idx = sample * batch; idx < last; ++idx)
+            {
+                G.edge(std::get<0>(w.edges[idx]), std::get<1>(w.edges[idx]), std::get<2>(w.edges[idx]));
+            }
+        });
+    }
+
+    {
+        estd::unweighted_digraph<int> G;
+        std::vector<int> values(n, 0);
+
+        G.insert(values.begin(), values.end());
+
+        add("edge_unweighted", (m + batch - 1) / batch, batch, [&] (size_t sample) {
+            size_t last = std::min(m, (sample + 1) * batch);
+
+            for (size_t idx = sample * batch; idx < last; ++idx)
+            {
+                G.edge(std::get<0>(w.edges[idx]), std::get<1>(w.edges[idx]));
+            }
+        });
+    }
+
+    add("insert_edges", 5, m, [&] (size_t) {
+        graph_type G = build(w);
+        sink = sink + G.size();
+    });
+
+    add("graph_builder", 5, m, [&] (size_t) {
+        graph_type G;
+        std::vector<int> values(n, 0);
+        estd::graph_builder<int, weight_type> builder;
+
+        G.insert(values.begin(), values.end());
+
+        // Every thread adds its own slice of the edges, as parallel producers would
+        estd::execution::parallel_for(0, m, 1 << 16, [&] (size_t first, size_t last, unsigned) {
+            for (size_t idx = first; idx < last; ++idx)
+            {
+                builder.add_edge(std::get<0>(w.edges[idx]), std::get<1>(w.edges[idx]), std::get<2>(w.edges[idx]));
+            }
+        });
+
+        builder.build(G);
+        sink = sink + G.size();
+    });
+
+    graph_type G = build(w);
+    G.set_path_cache_capacity(0);
+
+    std::vector<size_t> roots(64);
+
+    for (size_t& root : roots)
+    {
+        root = rng() % n;
+    }
+
+    add("size", 1000, 1, [&] (size_t) { sink = sink + G.size(); });
+
+    add("node_iterator_scan", 10, n, [&] (size_t) {
+        size_t count = 0;
+
+        for (auto it = G.nodes_begin(); it != G.nodes_end(); ++it)
+        {
+            count++;
+        }
+
+        sink = sink + count;
+    });
+
+    add("edge_iterator_scan", 10, m, [&] (size_t) {
+        size_t count = 0;
+
+        for (auto it = G.edges_begin(); it != G.edges_end(); ++it)
+        {
+            count++;
+        }
+
+        sink = sink + count;
+    });
+
+    add("dfs_search_iterator", roots.size(), 1, [&] (size_t sample) { sink = sink + visit<estd::search_algorithm::dfs>(G, roots[sample]); });
+    add("bfs_search_iterator", roots.size(), 1, [&] (size_t sample) { sink = sink + visit<estd::search_algorithm::bfs>(G, roots[sample]); });
+    add("bfs_distance", roots.size(), 1, [&] (size_t sample) { sink = sink + estd::bfs_distance(G, roots[sample]).root(); });
+    add("bellman_ford", 8, 1, [&] (size_t sample) { sink = sink + estd::bellman_ford(G, roots[sample]).root(); });
+
+    add("weakly_connected_components", 5, n, [&] (size_t) { sink = sink + estd::weakly_connected_components(G).count; });
+    add("strongly_connected_components", 5, n, [&] (size_t) { sink = sink + estd::strongly_connected_components(G).count; });
+    add("pagerank", 3, n, [&] (size_t) { sink = sink + estd::pagerank(G, 0.85, 1e-6, 100, 1).iterations; });
+
+    if (enabled("reorder_rcm") || enabled("bfs_distance_rcm"))
+    {
+        graph_type H = G;
+        std::vector<size_t> H_roots = roots;
+
+        auto relabel = [&H, &H_roots] () {
+            auto remap = estd::reorder(H);
+
+            for (size_t& root : H_roots)
+            {
+                root = remap[root];
+            }
+        };
+
+        relabel();
+        add("reorder_rcm", 3, n, [&] (size_t) { relabel(); });
+        add("bfs_distance_rcm", roots.size(), 1, [&] (size_t sample) { sink = sink + estd::bfs_distance(H, H_roots[sample]).root(); });
+    }
+
+    add("path_distance_query", roots.size(), 1, [&] (size_t sample) {
+        auto start = G.begin<estd::search_algorithm::bfs>(roots[sample]);
+        auto goal = G.begin<estd::search_algorithm::bfs>(roots[(sample + 1) % roots.size()]);
+        sink = sink + static_cast<size_t>(goal - start);
+    });
+
+    add("path_query", roots.size(), 1, [&] (size_t sample) {
+        auto start = G.begin<estd::search_algorithm::bfs>(roots[sample]);
+        auto goal = G.begin<estd::search_algorithm::bfs>(roots[(sample + 1) % roots.size()]);
+        sink = sink + (start > goal).size();
+    });
+
+    add("shortest_paths_tree", roots.size(), 1, [&] (size_t sample) {
+        auto start = G.begin<estd::search_algorithm::bfs>(roots[sample]);
+        sink = sink + (start > G).root();
+    });
+
+    add("erase_single", 256, 1, [&] (size_t) {
+        size_t node = rng() % G.capacity();
+
+        if (G.is_valid(node))
+        {
+            G.erase(node);
+        }
+    });
+
+    add("erase_batch", 4, n / 16, [&] (size_t) {
+        graph_type::nodes_container nodes;
+
+        for (size_t idx = 0; idx < n / 16; ++idx)
+        {
+            nodes.push_back(rng() % G.capacity());
+        }
+
+        G.erase(nodes);
+    });
+}
+
+void print(const std::vector<result>& results, size_t scale, unsigned long seed)
+{
+    std::printf("{\n  \"scale\": %zu,\n  \"seed\": %lu,\n  \"results\": [\n", scale, seed);
+
+    for (size_t idx = 0; idx < results.size(); ++idx)
+    {
+        const result& r = results[idx];
+
+        std::printf(
+            "    { \"name\": \"%s\", \"graph\": \"%s\", \"ops\": %zu, \"seconds\": %.6f, \"ops_per_second\": %.1f, "
+            "\"latency_ns\": { \"p50\": %.1f, \"p90\": %.1f, \"p99\": %.1f, \"max\": %.1f }, \"peak_rss_kb\": %ld }%s\n",
+            r.name.c_str(), r.graph.c_str(), r.ops, r.seconds, r.seconds > 0 ? r.ops / r.seconds : 0.0,
+            percentile(r.latencies, 0.5), percentile(r.latencies, 0.9), percentile(r.latencies, 0.99), percentile(r.latencies, 1.0),
+            r.peak_rss_kb, idx + 1 < results.size() ? "," : ""
+        );
+    }
+
+    std::printf("  ]\n}\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t scale = 16;
+    unsigned long seed = 42;
+    std::string filter;
+
+    for (int idx = 1; idx + 1 < argc; idx += 2)
+    {
+        if (std::strcmp(argv[idx], "--scale") == 0)
+        {
+            scale = std::strtoul(argv[idx + 1], nullptr, 10);
+        }
+        else if (std::strcmp(argv[idx], "--seed") == 0)
+        {
+            seed = std::strtoul(argv[idx + 1], nullptr, 10);
+        }
+        else if (std::strcmp(argv[idx], "--filter") == 0)
+        {
+            filter = argv[idx + 1];
+        }
+    }
+
+    // Every graph has about 2^scale nodes
+    std::mt19937_64 rng { seed };
+    size_t n = size_t { 1 } << scale;
+    size_t side = static_cast<size_t>(1) << (scale / 2);
+    std::vector<result> results;
+
+    std::vector<workload> workloads;
+    workloads.push_back(erdos_renyi(n, 8 * n, rng));
+    workloads.push_back(rmat(scale, 8 * n, rng));
+    workloads.push_back(grid(side, rng));
+    workloads.push_back(deep_tree(n, rng));
+
+    for (const workload& w : workloads)
+    {
+        run(w, rng, filter, results);
+    }
+
+    print(results, scale, seed);
+
+    return 0;
+}
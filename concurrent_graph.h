@@ -0,0 +1,254 @@
+// MIT License
+
+// graph - http://www.github/ilariom/graph
+// Copyright (c) 2020 - Ilario Mangano
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef concurrent_graph_h
+#define concurrent_graph_h
+
+#include "graph.h"
+
+#include <memory>
+
+namespace estd
+{
+
+template <typename T, typename V>
+class concurrent_graph;
+
+// Immutable version of a concurrent_graph, as it was at one of its publish().
+// Any number of threads can visit and query the same snapshot, also while the writer
+// goes on: a snapshot keeps alive the blocks it's made of, so nothing changes under it.
+// Node ids are the same of the concurrent_graph, and the same iterators and path calculations
+// of csr_graph are available.
+template <typename T, typename V = ssize_t>
+class graph_snapshot
+{
+public:
+    using value_type = T;
+    using weight_type = V;
+    using size_type = size_t;
+    using id_type = size_t;
+    using path = typename graph<T, V>::path;
+    using path_array = typename graph<T, V>::path_array;
+    using path_result = typename graph<T, V>::path_result;
+    using edge_range = typename graph<T, V>::edge_range;
+    using nodes_container = std::vector<id_type>;
+    using weights_container = std::vector<weight_type>;
+
+    static constexpr const id_type null_id = graph<T, V>::null_id;
+
+    // Nodes per block. A block is the unit of copy on write
+    static constexpr const size_type block_size = 256;
+
+public:
+    template <typename container_type>
+    using search_iterator = basic_search_iterator<graph_snapshot<T, V>, container_type>;
+
+public:
+    graph_snapshot();
+
+public:
+    size_type degree(id_type node) const { return in(node).size() + out(node).size(); }
+    size_type order() const { return s_->order; }
+    size_type size() const { return s_->size; }
+    size_type capacity() const { return s_->capacity; }
+    bool empty() const { return order() == 0; }
+
+    // Number of the publish() this snapshot comes from, 0 before the first one
+    size_t version() const { return s_->version; }
+
+    const nodes_container& in(id_type node) const { return at(node).radjs; }
+    const nodes_container& out(id_type node) const { return at(node).adjs; }
+    const weights_container& in_weights(id_type node) const { return at(node).rws; }
+    const weights_container& out_weights(id_type node) const { return at(node).ws; }
+    edge_range in_edges(id_type node) const { return { in(node).data(), in_weights(node).data(), in(node).size() }; }
+    edge_range out_edges(id_type node) const { return { out(node).data(), out_weights(node).data(), out(node).size() }; }
+
+    const T& operator[](id_type node) const { return at(node).obj; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> begin(id_type root) const { return search_iterator<search_algorithm> { *this, false, root }; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> end() const { return search_iterator<search_algorithm> { *this, false }; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> rbegin(id_type root) const { return search_iterator<search_algorithm> { *this, true, root }; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> rend() const { return search_iterator<search_algorithm> { *this, true }; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> begin(id_type root, const search_algorithm& frontier) const { return search_iterator<search_algorithm> { *this, false, root, frontier }; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> end(const search_algorithm& frontier) const { return search_iterator<search_algorithm> { *this, false, null_id, frontier }; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> rbegin(id_type root, const search_algorithm& frontier) const { return search_iterator<search_algorithm> { *this, true, root, frontier }; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> rend(const search_algorithm& frontier) const { return search_iterator<search_algorithm> { *this, true, null_id, frontier }; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> begin(id_type root, traversal_workspace<search_algorithm>& workspace) const { return search_iterator<search_algorithm> { *this, false, root, workspace }; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> rbegin(id_type root, traversal_workspace<search_algorithm>& workspace) const { return search_iterator<search_algorithm> { *this, true, root, workspace }; }
+
+    // Weight of the last edge from node to child, as for graph
+    weight_type weight(id_type node, id_type child) const { return sssp::weight(*this, node, child); }
+    bool is_weighted() const { return s_->weighted; }
+    bool has_negative_weights() const { return s_->negative_weights; }
+    bool is_valid(id_type node) const { return node < capacity() && at(node).valid; }
+
+    // Same as graph, with nothing cached: every call runs a new search
+    std::shared_ptr<const path> shortest_paths(id_type root) const { return std::make_shared<const path>(sssp::solve(*this, root)); }
+    path_result shortest_path(id_type source, id_type target) const;
+
+private:
+    friend class concurrent_graph<T, V>;
+
+    struct entry
+    {
+        value_type obj {};
+        nodes_container adjs;
+        nodes_container radjs;
+        weights_container ws;
+        weights_container rws;
+        bool valid = false;
+    };
+
+    using block = std::vector<entry>;
+
+    struct state
+    {
+        std::vector<std::shared_ptr<const block>> blocks;
+        size_type capacity = 0;
+        size_type size = 0;
+        size_type order = 0;
+        bool weighted = false;
+        bool negative_weights = false;
+        size_t version = 0;
+    };
+
+private:
+    explicit graph_snapshot(std::shared_ptr<const state> s)
+        : s_(std::move(s))
+    { }
+
+    const entry& at(id_type node) const { return (*s_->blocks[node / block_size])[node % block_size]; }
+
+private:
+    std::shared_ptr<const state> s_;
+};
+
+// Graph shared by many reader threads and a single writer.
+// The writer changes the graph with insert, edge and erase, as with graph, and makes
+// a batch of changes visible to readers all at once with publish(). Readers call read()
+// to get the last published version, and can visit it for as long as they like.
+// Nodes live in blocks shared among versions: the first change to a block after a publish()
+// copies it, so a batch costs the blocks it touches. A version is freed, together with
+// the blocks nobody else uses, when the last snapshot of it goes away.
+template <typename T, typename V = ssize_t>
+class concurrent_graph
+{
+public:
+    using snapshot = graph_snapshot<T, V>;
+    using value_type = T;
+    using weight_type = V;
+    using size_type = size_t;
+    using id_type = size_t;
+
+    static constexpr const id_type null_id = snapshot::null_id;
+
+public:
+    concurrent_graph();
+    template <typename W, typename A>
+    explicit concurrent_graph(const graph<T, W, A>& G);
+
+    concurrent_graph(const concurrent_graph&) = delete;
+    concurrent_graph& operator=(const concurrent_graph&) = delete;
+
+public:
+    // Writer side. Changes are seen by readers only after publish(),
+    // and these functions must not be called by more than one thread at a time
+    id_type insert(
+        typename std::conditional<std::is_arithmetic<value_type>::value, value_type,
+        const value_type&>::type val
+    );
+    void edge(id_type node, id_type child, weight_type w = 1);
+    void erase(id_type node);
+    void erase(id_type node, id_type child);
+
+    // Makes every change done so far visible to read(), and returns the number of the new version
+    size_t publish();
+
+    // State of the writer, unpublished changes included
+    size_type order() const { return order_; }
+    size_type size() const { return size_; }
+    size_type capacity() const { return capacity_; }
+    bool is_valid(id_type node) const { return node < capacity_ && at(node).valid; }
+
+    // Reader side, safe to call from any thread at any time
+    snapshot read() const;
+
+private:
+    using entry = typename snapshot::entry;
+    using block = typename snapshot::block;
+    using state = typename snapshot::state;
+
+private:
+    const entry& at(id_type node) const { return (*blocks_[node / snapshot::block_size])[node % snapshot::block_size]; }
+    entry& touch(id_type node);
+
+private:
+    std::vector<std::shared_ptr<block>> blocks_;
+    // Version being built when each block has been copied: blocks stamped with
+    // the current batch are not shared with any snapshot and can be changed in place
+    std::vector<size_t> stamps_;
+    std::vector<id_type> free_;
+    size_type capacity_ = 0;
+    size_type size_ = 0;
+    size_type order_ = 0;
+    bool weighted_ = false;
+    bool negative_weights_ = false;
+    size_t version_ = 0;
+    // Only accessed through std::atomic_load and std::atomic_store
+    std::shared_ptr<const state> published_;
+};
+
+template <typename T, typename V>
+typename graph_snapshot<T, V>::path bfs_distance(const graph_snapshot<T, V>& G, typename graph_snapshot<T, V>::id_type root);
+
+template <typename T, typename V>
+typename graph_snapshot<T, V>::path bellman_ford(const graph_snapshot<T, V>& G, typename graph_snapshot<T, V>::id_type root);
+
+template <typename queue_type = heap::binary, typename T, typename V>
+typename graph_snapshot<T, V>::path dijkstra(const graph_snapshot<T, V>& G, typename graph_snapshot<T, V>::id_type root);
+
+#include "concurrent_graph.inl"
+
+} // namespace estd
+
+#endif /* concurrent_graph_h */
@@ -0,0 +1,282 @@
+template <typename T, typename V>
+constexpr const typename graph_snapshot<T, V>::id_type graph_snapshot<T, V>::null_id;
+
+template <typename T, typename V>
+constexpr const typename graph_snapshot<T, V>::size_type graph_snapshot<T, V>::block_size;
+
+template <typename T, typename V>
+inline graph_snapshot<T, V>::graph_snapshot()
+    : s_(std::make_shared<state>())
+{ }
+
+template <typename T, typename V>
+inline typename graph_snapshot<T, V>::path_result graph_snapshot<T, V>::shortest_path(id_type source, id_type target) const
+{
+    if (source >= capacity() || target >= capacity())
+    {
+        return { {}, std::numeric_limits<weight_type>::max() };
+    }
+
+    path paths = sssp::solve(*this, source);
+    return { paths.path_to(target), paths.distance_to(target) };
+}
+
+template <typename T, typename V>
+constexpr const typename concurrent_graph<T, V>::id_type concurrent_graph<T, V>::null_id;
+
+template <typename T, typename V>
+inline concurrent_graph<T, V>::concurrent_graph()
+    : published_(std::make_shared<state>())
+{ }
+
+template <typename T, typename V>
+template <typename W, typename A>
+inline concurrent_graph<T, V>::concurrent_graph(const graph<T, W, A>& G)
+    : concurrent_graph()
+{
+    static_assert(std::is_same<typename graph<T, W, A>::weight_type, V>::value, "Weights must be of the same type, or unit weights of an unweighted graph");
+
+    size_type n = G.capacity();
+    size_type blocks = (n + snapshot::block_size - 1) / snapshot::block_size;
+
+    blocks_.reserve(blocks);
+    stamps_.assign(blocks, version_ + 1);
+
+    for (size_type b = 0; b < blocks; ++b)
+    {
+        blocks_.push_back(std::make_shared<block>(snapshot::block_size));
+    }
+
+    for (id_type node = 0; node < n; ++node)
+    {
+        entry& e = touch(node);
+
+        for (auto edge : G.out_edges(node))
+        {
+            e.adjs.push_back(edge.first);
+            e.ws.push_back(edge.second);
+        }
+
+        for (auto edge : G.in_edges(node))
+        {
+            e.radjs.push_back(edge.first);
+            e.rws.push_back(edge.second);
+        }
+
+        if (G.is_valid(node))
+        {
+            e.obj = G[node];
+            e.valid = true;
+        }
+        else
+        {
+            free_.push_back(node);
+        }
+    }
+
+    capacity_ = n;
+    size_ = G.size();
+    order_ = G.order();
+    weighted_ = G.is_weighted();
+    negative_weights_ = G.has_negative_weights();
+
+    publish();
+}
+
+template <typename T, typename V>
+inline typename concurrent_graph<T, V>::entry& concurrent_graph<T, V>::touch(id_type node)
+{
+    size_type b = node / snapshot::block_size;
+
+    if (stamps_[b] != version_ + 1)
+    {
+        blocks_[b] = std::make_shared<block>(*blocks_[b]);
+        stamps_[b] = version_ + 1;
+    }
+
+    return (*blocks_[b])[node % snapshot::block_size];
+}
+
+template <typename T, typename V>
+inline typename concurrent_graph<T, V>::id_type concurrent_graph<T, V>::insert(
+    typename std::conditional<std::is_arithmetic<value_type>::value, value_type,
+    const value_type&>::type val
+)
+{
+    id_type node;
+
+    if (!free_.empty())
+    {
+        node = free_.back();
+        free_.pop_back();
+    }
+    else
+    {
+        if (capacity_ % snapshot::block_size == 0)
+        {
+            blocks_.push_back(std::make_shared<block>(snapshot::block_size));
+            stamps_.push_back(version_ + 1);
+        }
+
+        node = capacity_++;
+    }
+
+    entry& e = touch(node);
+    e.obj = val;
+    e.valid = true;
+    order_++;
+
+    return node;
+}
+
+template <typename T, typename V>
+inline void concurrent_graph<T, V>::edge(id_type node, id_type child, weight_type w)
+{
+    entry& from = touch(node);
+    from.adjs.push_back(child);
+    from.ws.push_back(w);
+
+    entry& to = touch(child);
+    to.radjs.push_back(node);
+    to.rws.push_back(w);
+
+    size_++;
+
+    if (w != 1)
+    {
+        weighted_ = true;
+    }
+
+    if (w < weight_type {})
+    {
+        negative_weights_ = true;
+    }
+}
+
+template <typename T, typename V>
+inline void concurrent_graph<T, V>::erase(id_type node)
+{
+    if (!is_valid(node))
+    {
+        return;
+    }
+
+    auto drop = [node] (typename snapshot::nodes_container& adjs, typename snapshot::weights_container& ws) -> size_type {
+        size_t k = 0;
+
+        for (size_t idx = 0; idx < adjs.size(); ++idx)
+        {
+            if (adjs[idx] != node)
+            {
+                adjs[k] = adjs[idx];
+                ws[k] = ws[idx];
+                ++k;
+            }
+        }
+
+        size_type dropped = adjs.size() - k;
+        adjs.resize(k);
+        ws.resize(k);
+
+        return dropped;
+    };
+
+    // Blocks are replaced, never moved, so this reference survives touching other nodes
+    entry& e = touch(node);
+    size_ -= e.adjs.size();
+
+    for (id_type child : e.adjs)
+    {
+        if (child != node)
+        {
+            entry& other = touch(child);
+            drop(other.radjs, other.rws);
+        }
+    }
+
+    for (id_type parent : e.radjs)
+    {
+        if (parent != node)
+        {
+            entry& other = touch(parent);
+            size_ -= drop(other.adjs, other.ws);
+        }
+    }
+
+    e = entry {};
+    free_.push_back(node);
+    order_--;
+}
+
+template <typename T, typename V>
+inline void concurrent_graph<T, V>::erase(id_type node, id_type child)
+{
+    const typename snapshot::nodes_container& adjs = at(node).adjs;
+    const typename snapshot::nodes_container& radjs = at(child).radjs;
+
+    // Only blocks that really change get copied
+    bool linked = std::find(adjs.begin(), adjs.end(), child) != adjs.end();
+    bool rlinked = std::find(radjs.begin(), radjs.end(), node) != radjs.end();
+
+    if (linked)
+    {
+        entry& from = touch(node);
+        auto it = std::find(from.adjs.begin(), from.adjs.end(), child);
+        from.ws.erase(from.ws.begin() + (it - from.adjs.begin()));
+        from.adjs.erase(it);
+        size_--;
+    }
+
+    if (rlinked)
+    {
+        entry& to = touch(child);
+        auto rit = std::find(to.radjs.begin(), to.radjs.end(), node);
+        to.rws.erase(to.rws.begin() + (rit - to.radjs.begin()));
+        to.radjs.erase(rit);
+    }
+}
+
+template <typename T, typename V>
+inline size_t concurrent_graph<T, V>::publish()
+{
+    std::shared_ptr<state> s = std::make_shared<state>();
+
+    s->blocks.assign(blocks_.begin(), blocks_.end());
+    s->capacity = capacity_;
+    s->size = size_;
+    s->order = order_;
+    s->weighted = weighted_;
+    s->negative_weights = negative_weights_;
+    s->version = ++version_;
+
+    // From now on every block is shared with the snapshot, and gets copied before the next change
+    std::atomic_store(&published_, std::shared_ptr<const state>(std::move(s)));
+
+    return version_;
+}
+
+template <typename T, typename V>
+inline typename concurrent_graph<T, V>::snapshot concurrent_graph<T, V>::read() const
+{
+    return snapshot { std::atomic_load(&published_) };
+}
+
+template <typename T, typename V>
+inline typename graph_snapshot<T, V>::path bfs_distance(const graph_snapshot<T, V>& G, typename graph_snapshot<T, V>::id_type root)
+{
+    null_stats stats;
+    return sssp::bfs(G, root, stats);
+}
+
+template <typename T, typename V>
+inline typename graph_snapshot<T, V>::path bellman_ford(const graph_snapshot<T, V>& G, typename graph_snapshot<T, V>::id_type root)
+{
+    null_stats stats;
+    return sssp::bellman_ford(G, root, stats);
+}
+
+template <typename queue_type, typename T, typename V>
+inline typename graph_snapshot<T, V>::path dijkstra(const graph_snapshot<T, V>& G, typename graph_snapshot<T, V>::id_type root)
+{
+    return sssp::dijkstra<queue_type>(G, root);
+}
@@ -0,0 +1,190 @@
+// MIT License
+
+// graph - http://www.github/ilariom/graph
+// Copyright (c) 2020 - Ilario Mangano
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef csr_graph_h
+#define csr_graph_h
+
+#include "graph.h"
+
+#include <string>
+
+namespace estd
+{
+
+// Immutable compressed sparse row snapshot of a graph.
+// Node ids are the same of the graph it has been built from, so ids can be
+// freely exchanged between the two. Adjacency, reverse adjacency and weights
+// are stored in contiguous arrays, which makes it the right choice when a graph
+// is built once and then queried many times.
+// Copies share the same arrays, which may also live in a memory mapped file (see graph_io.h).
+template <typename T, typename V = ssize_t>
+class csr_graph
+{
+public:
+    using value_type = T;
+    using weight_type = V;
+    using size_type = size_t;
+    using id_type = size_t;
+    using path = typename graph<T, V>::path;
+    using path_array = typename graph<T, V>::path_array;
+    using path_result = typename graph<T, V>::path_result;
+    using edge_range = typename graph<T, V>::edge_range;
+
+    static constexpr const id_type null_id = graph<T, V>::null_id;
+
+public:
+    template <typename U>
+    class span
+    {
+    public:
+        span(const U* first = nullptr, const U* last = nullptr)
+            : first_(first), last_(last)
+        { }
+
+    public:
+        const U* begin() const { return first_; }
+        const U* end() const { return last_; }
+        size_type size() const { return last_ - first_; }
+        bool empty() const { return first_ == last_; }
+        const U& operator[](size_type idx) const { return first_[idx]; }
+
+    private:
+        const U* first_;
+        const U* last_;
+    };
+
+    using nodes_range = span<id_type>;
+    using weights_range = span<weight_type>;
+
+    template <typename container_type>
+    using search_iterator = basic_search_iterator<csr_graph<T, V>, container_type>;
+
+public:
+    csr_graph() = default;
+    template <typename W, typename A>
+    explicit csr_graph(const graph<T, W, A>& G);
+
+public:
+    size_type degree(id_type node) const { return in(node).size() + out(node).size(); }
+    size_type order() const { return order_; }
+    size_type size() const { return size_; }
+    size_type capacity() const { return capacity_; }
+    bool empty() const { return order() == 0; }
+
+    nodes_range in(id_type node) const { return { rtargets_ + roffsets_[node], rtargets_ + roffsets_[node + 1] }; }
+    nodes_range out(id_type node) const { return { targets_ + offsets_[node], targets_ + offsets_[node + 1] }; }
+    weights_range in_weights(id_type node) const { return { rweights_ + roffsets_[node], rweights_ + roffsets_[node + 1] }; }
+    weights_range out_weights(id_type node) const { return { weights_ + offsets_[node], weights_ + offsets_[node + 1] }; }
+    edge_range in_edges(id_type node) const { return { rtargets_ + roffsets_[node], rweights_ + roffsets_[node], roffsets_[node + 1] - roffsets_[node] }; }
+    edge_range out_edges(id_type node) const { return { targets_ + offsets_[node], weights_ + offsets_[node], offsets_[node + 1] - offsets_[node] }; }
+
+    const T& operator[](id_type node) const { return objs_[node]; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> begin(id_type root) const { return search_iterator<search_algorithm> { *this, false, root }; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> end() const { return search_iterator<search_algorithm> { *this, false }; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> rbegin(id_type root) const { return search_iterator<search_algorithm> { *this, true, root }; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> rend() const { return search_iterator<search_algorithm> { *this, true }; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> begin(id_type root, const search_algorithm& frontier) const { return search_iterator<search_algorithm> { *this, false, root, frontier }; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> end(const search_algorithm& frontier) const { return search_iterator<search_algorithm> { *this, false, null_id, frontier }; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> rbegin(id_type root, const search_algorithm& frontier) const { return search_iterator<search_algorithm> { *this, true, root, frontier }; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> rend(const search_algorithm& frontier) const { return search_iterator<search_algorithm> { *this, true, null_id, frontier }; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> begin(id_type root, traversal_workspace<search_algorithm>& workspace) const { return search_iterator<search_algorithm> { *this, false, root, workspace }; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> rbegin(id_type root, traversal_workspace<search_algorithm>& workspace) const { return search_iterator<search_algorithm> { *this, true, root, workspace }; }
+
+    // Weight of the last edge from node to child, as for graph
+    weight_type weight(id_type node, id_type child) const { return sssp::weight(*this, node, child); }
+    bool is_weighted() const { return weighted_; }
+    bool has_negative_weights() const { return negative_weights_; }
+    bool is_valid(id_type node) const { return node < capacity_ && valid_[node]; }
+
+    // Same as graph, with nothing cached: every call runs a new search
+    std::shared_ptr<const path> shortest_paths(id_type root) const { return std::make_shared<const path>(sssp::solve(*this, root)); }
+    path_result shortest_path(id_type source, id_type target) const;
+
+private:
+    template <typename U, typename W>
+    friend bool map_graph(const std::string& filename, csr_graph<U, W>& G);
+
+    struct storage
+    {
+        std::vector<size_type> offsets;
+        std::vector<size_type> roffsets;
+        std::vector<id_type> targets;
+        std::vector<id_type> rtargets;
+        std::vector<weight_type> weights;
+        std::vector<weight_type> rweights;
+        std::vector<value_type> objs;
+        std::vector<unsigned char> valid;
+    };
+
+private:
+    // Keeps alive the memory the arrays below point to
+    std::shared_ptr<const void> storage_;
+    const size_type* offsets_ = nullptr;
+    const size_type* roffsets_ = nullptr;
+    const id_type* targets_ = nullptr;
+    const id_type* rtargets_ = nullptr;
+    const weight_type* weights_ = nullptr;
+    const weight_type* rweights_ = nullptr;
+    const value_type* objs_ = nullptr;
+    const unsigned char* valid_ = nullptr;
+    size_type capacity_ = 0;
+    size_type size_ = 0;
+    size_type order_ = 0;
+    bool weighted_ = false;
+    bool negative_weights_ = false;
+};
+
+template <typename T, typename V>
+typename csr_graph<T, V>::path bfs_distance(const csr_graph<T, V>& G, typename csr_graph<T, V>::id_type root);
+
+template <typename T, typename V>
+typename csr_graph<T, V>::path bellman_ford(const csr_graph<T, V>& G, typename csr_graph<T, V>::id_type root);
+
+template <typename queue_type = heap::binary, typename T, typename V>
+typename csr_graph<T, V>::path dijkstra(const csr_graph<T, V>& G, typename csr_graph<T, V>::id_type root);
+
+#include "csr_graph.inl"
+
+} // namespace estd
+
+#endif /* csr_graph_h */
@@ -0,0 +1,91 @@
+template <typename T, typename V>
+constexpr const typename csr_graph<T, V>::id_type csr_graph<T, V>::null_id;
+
+template <typename T, typename V>
+template <typename W, typename A>
+inline csr_graph<T, V>::csr_graph(const graph<T, W, A>& G)
+    : capacity_(G.capacity()), size_(G.size()), order_(G.order()),
+      weighted_(G.is_weighted()), negative_weights_(G.has_negative_weights())
+{
+    static_assert(std::is_same<typename graph<T, W, A>::weight_type, V>::value, "Weights must be of the same type, or unit weights of an unweighted graph");
+
+    size_type n = G.capacity();
+    size_type m = G.size();
+
+    std::shared_ptr<storage> s = std::make_shared<storage>();
+
+    s->offsets.resize(n + 1, 0);
+    s->roffsets.resize(n + 1, 0);
+    s->targets.reserve(m);
+    s->rtargets.reserve(m);
+    s->weights.reserve(m);
+    s->rweights.reserve(m);
+    s->objs.resize(n);
+    s->valid.resize(n, 0);
+
+    for (id_type node = 0; node < n; ++node)
+    {
+        for (auto e : G.out_edges(node))
+        {
+            s->targets.push_back(e.first);
+            s->weights.push_back(e.second);
+        }
+
+        for (auto e : G.in_edges(node))
+        {
+            s->rtargets.push_back(e.first);
+            s->rweights.push_back(e.second);
+        }
+
+        s->offsets[node + 1] = s->targets.size();
+        s->roffsets[node + 1] = s->rtargets.size();
+
+        if (G.is_valid(node))
+        {
+            s->objs[node] = G[node];
+            s->valid[node] = 1;
+        }
+    }
+
+    offsets_ = s->offsets.data();
+    roffsets_ = s->roffsets.data();
+    targets_ = s->targets.data();
+    rtargets_ = s->rtargets.data();
+    weights_ = s->weights.data();
+    rweights_ = s->rweights.data();
+    objs_ = s->objs.data();
+    valid_ = s->valid.data();
+    storage_ = std::move(s);
+}
+
+template <typename T, typename V>
+inline typename csr_graph<T, V>::path_result csr_graph<T, V>::shortest_path(id_type source, id_type target) const
+{
+    if (source >= capacity() || target >= capacity())
+    {
+        return { {}, std::numeric_limits<weight_type>::max() };
+    }
+
+    path paths = sssp::solve(*this, source);
+    return { paths.path_to(target), paths.distance_to(target) };
+}
+
+template <typename T, typename V>
+inline typename csr_graph<T, V>::path bfs_distance(const csr_graph<T, V>& G, typename csr_graph<T, V>::id_type root)
+{
+    null_stats stats;
+    return sssp::bfs(G, root, stats);
+}
+
+template <typename T, typename V>
+inline typename csr_graph<T, V>::path bellman_ford(const csr_graph<T, V>& G, typename csr_graph<T, V>::id_type root)
+{
+    null_stats stats;
+    return sssp::bellman_ford(G, root, stats);
+}
+
+template <typename queue_type, typename T, typename V>
+inline typename csr_graph<T, V>::path dijkstra(const csr_graph<T, V>& G, typename csr_graph<T, V>::id_type root)
+{
+    return sssp::dijkstra<queue_type>(G, root);
+}
@@ -29,25 +29,47 @@
 #include <unordered_map>
 #include <stack>
 #include <queue>
+#include <deque>
 #include <limits>
 #include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <iterator>
+#include <iosfwd>
+#include <chrono>
+#include <cstring>
 
 namespace estd
 {
 
+#include "heap.inl"
+#include "traversal.inl"
+#include "arena.inl"
+#include "weights.inl"
 #include "search_algorithm.inl"
+#include "search_iterator.inl"
 
-template <typename T, typename V = ssize_t>
+// V is the type of the weights, or void for an unweighted graph, that stores none (see unweighted_digraph).
+// A is the allocator for the node values. It is rebound for adjacency lists,
+// weights and bookkeeping, so every vector of the graph allocates through it (see arena).
+template <typename T, typename V = ssize_t, typename A = std::allocator<T>>
 class graph
 {
 public:
     using value_type = T;
-    using weight_type = V;
+    using weight_type = typename weight_storage<V, A>::weight_type;
+    using allocator_type = A;
     using size_type = size_t;
     using id_type = size_t;
-    using nodes_container = std::vector<id_type>;
+    using nodes_container = std::vector<id_type, typename std::allocator_traits<A>::template rebind_alloc<id_type>>;
+    using weights_container = typename weight_storage<V, A>::weights_container;
+    using adjacency_container = std::vector<nodes_container, typename std::allocator_traits<A>::template rebind_alloc<nodes_container>>;
     using parent_array = std::vector<id_type>;
     using path_array = std::vector<id_type>;
+    using id_map = std::vector<id_type>;
+    using path_result = std::pair<path_array, weight_type>;
     
     static constexpr const id_type null_id = std::numeric_limits<id_type>::max();
     
@@ -58,81 +80,140 @@ public:
         path(
             parent_array&& parents, 
             std::vector<weight_type>&& distances, 
-            graph<T, V>::id_type root
+            graph<T, V, A>::id_type root
         )
-            : parents_(parents), distances_(distances), root_(root)
+            : parents_(std::move(parents)), distances_(std::move(distances)), root_(root)
         { }
 
         path() = default;
 
     public:
-        graph<T, V>::id_type root() const { return root_; }
+        graph<T, V, A>::id_type root() const { return root_; }
         path_array path_to(id_type node) const;
         weight_type distance_to(id_type node) const { return distances_[node]; }
+        size_type memory_usage() const { return parents_.capacity() * sizeof(id_type) + distances_.capacity() * sizeof(weight_type); }
 
     private : 
         parent_array parents_;
         std::vector<weight_type> distances_;
-        graph<T, V>::id_type root_ = graph<T, V>::null_id;
+        graph<T, V, A>::id_type root_ = graph<T, V, A>::null_id;
     };
 
-    template <typename container_type>
-    class search_iterator
+    // Small LRU cache of shortest path trees, keyed by root and algorithm.
+    // Entries computed on an older version of the graph are dropped on lookup.
+    class path_cache
     {
     public:
-        search_iterator(
-            const graph<T, V>& G,
-            const std::vector<std::vector<graph<T, V>::id_type>>& children,
-            graph<T, V>::id_type root = graph<T, V>::null_id
-        ) : G_(G), children_(children), curr_(root), root_(root)
+        enum class algorithm { bfs, dijkstra, bellman_ford };
+
+    public:
+        explicit path_cache(size_type capacity = 8)
+            : capacity_(capacity)
+        { }
+
+        path_cache(const path_cache& other)
+            : capacity_(other.capacity())
+        { }
+
+        path_cache& operator=(const path_cache& other);
+
+    public:
+        std::shared_ptr<const path> find(id_type root, algorithm alg, size_type version) const;
+        void store(id_type root, algorithm alg, size_type version, std::shared_ptr<const path> paths);
+        bool missed_before(id_type root, algorithm alg, size_type version);
+        size_type capacity() const;
+        void set_capacity(size_type capacity);
+        void clear();
+        size_type memory_usage() const;
+
+    private:
+        struct entry
         {
-            frontier_.set_graph(G_);
-            frontier_.push(root);
-            step();
-        }
-        
-        search_iterator(const search_iterator& it)
-            : G_(it.G_), children_(it.children_), curr_(it.curr_), root_(it.root_)
+            id_type root;
+            algorithm alg;
+            size_type version;
+            std::shared_ptr<const path> paths;
+            size_type last_use;
+        };
+
+    private:
+        mutable std::mutex mutex_;
+        mutable std::vector<entry> entries_;
+        std::vector<entry> misses_;
+        mutable size_type clock_ = 0;
+        size_type capacity_;
+    };
+
+    // Edges leaving (or entering) a node, as (adjacent node, weight) pairs.
+    // Unweighted graphs have no weights to point to: weights() is null, and every weight is 1.
+    class edge_range
+    {
+    public:
+        using value_type = std::pair<graph<T, V, A>::id_type, graph<T, V, A>::weight_type>;
+
+        class iterator
         {
-            frontier_.set_graph(G_);
-            frontier_.push(curr_);
-            step();
-        }
-        
+        public:
+            iterator(const id_type* id, const weight_type* w)
+                : id_(id), w_(w)
+            { }
+
+        public:
+            value_type operator*() const { return { *id_, w_ != nullptr ? *w_ : 1 }; }
+            iterator& operator++() { ++id_; w_ += w_ != nullptr ? 1 : 0; return *this; }
+
+            bool operator==(const iterator& other) const { return id_ == other.id_; }
+            bool operator!=(const iterator& other) const { return !(*this == other); }
+
+        private:
+            const id_type* id_;
+            const weight_type* w_;
+        };
+
     public:
-        graph<T, V>::id_type operator*() const { return curr_; }
-        search_iterator& operator++();
-        graph<T, V>::weight_type operator-(const search_iterator& other) const;
-        std::vector<graph<T, V>::id_type> operator<(const search_iterator& other) const;
-        std::vector<graph<T, V>::id_type> operator>(const search_iterator& other) const { return other < *this; }
-        graph<T, V>::path operator>(const graph<T, V>&) const;
-        
-        bool operator==(const search_iterator& other) const { return curr_ == other.curr_; }
-        bool operator!=(const search_iterator& other) const { return !(*this == other); }
-        
-        void prune() { prune_ = true; }
-        void rewind();
+        edge_range(const id_type* ids, const weight_type* ws, size_type n)
+            : ids_(ids), ws_(ws), n_(n)
+        { }
+
+    public:
+        iterator begin() const { return { ids_, ws_ }; }
+        iterator end() const { return { ids_ + n_, ws_ != nullptr ? ws_ + n_ : nullptr }; }
+        size_type size() const { return n_; }
+        bool empty() const { return n_ == 0; }
+        value_type operator[](size_type idx) const { return { ids_[idx], weight(idx) }; }
+        id_type target(size_type idx) const { return ids_[idx]; }
+        weight_type weight(size_type idx) const { return ws_ != nullptr ? ws_[idx] : 1; }
+        const id_type* targets() const { return ids_; }
+        const weight_type* weights() const { return ws_; }
 
-        graph<T, V>::id_type peek() const { return frontier_.empty() ? graph<T, V>::null_id : frontier_.top(); }
-        
-    private:
-        void step();
-        
     private:
-        const graph<T, V>& G_;
-        std::unordered_set<id_type> E_;
-        container_type frontier_;
-        const std::vector<std::vector<graph<T, V>::id_type>>& children_;
-        graph<T, V>::id_type curr_;
-        graph<T, V>::id_type root_;
-        bool prune_ = false;
+        const id_type* ids_;
+        const weight_type* ws_;
+        size_type n_;
+    };
+
+    template <typename container_type, typename stats_type = null_stats>
+    using search_iterator = basic_search_iterator<graph<T, V, A>, container_type, stats_type>;
+
+    // Bytes allocated by each part of a graph. Memory owned by node values
+    // themselves (e.g. the characters of a std::string) is not included.
+    struct memory_report
+    {
+        size_type adjs = 0;
+        size_type radjs = 0;
+        size_type weights = 0;
+        size_type objs = 0;
+        size_type liveness = 0;
+        size_type path_cache = 0;
+
+        size_type total() const { return adjs + radjs + weights + objs + liveness + path_cache; }
     };
 
     class node_iterator
     {
     public:
-        node_iterator(const graph<T, V>& G, graph<T, V>::id_type v = graph<T, V>::null_id)
-            : G_(G), v_(v)
+        node_iterator(const graph<T, V, A>& G, graph<T, V, A>::id_type v = graph<T, V, A>::null_id)
+            : G_(G), v_(G.next_live(v))
         { }
         
     public:
@@ -147,16 +228,16 @@ public:
         bool operator!=(const node_iterator& other) const { return !(*this == other); }
         
     private:
-        const graph<T, V>& G_;
-        graph<T, V>::id_type v_;
+        const graph<T, V, A>& G_;
+        graph<T, V, A>::id_type v_;
     };
 
-    using edge_type = std::pair<graph<T, V>::id_type, graph<T, V>::id_type>;
+    using edge_type = std::pair<graph<T, V, A>::id_type, graph<T, V, A>::id_type>;
     
     class edge_iterator
     {
     public:
-        edge_iterator(const graph<T, V>& G, graph<T, V>::id_type u = graph<T, V>::null_id)
+        edge_iterator(const graph<T, V, A>& G, graph<T, V, A>::id_type u = graph<T, V, A>::null_id)
             : G_(G), it_{ G_, u }
         {
             ++*this;
@@ -173,44 +254,113 @@ public:
         bool ensure_validity();
         
     private:
-        const graph<T, V>& G_;
+        const graph<T, V, A>& G_;
         node_iterator it_;
         size_t adjs_idx_ = 0;
-        id_type u_ = graph<T, V>::null_id;
-        id_type v_ = graph<T, V>::null_id;
+        id_type u_ = graph<T, V, A>::null_id;
+        id_type v_ = graph<T, V, A>::null_id;
     };
     
+public:
+    graph() = default;
+    explicit graph(const allocator_type& alloc);
+
 public:
     id_type insert(typename std::conditional<std::is_arithmetic<value_type>::value, value_type, const value_type&>::type);
+
+    // Appends the values in [first, last) as new nodes with consecutive ids and returns the first id.
+    template <typename iterator_type>
+    id_type insert(iterator_type first, iterator_type last);
+
+    // Adds every edge in [first, last), given as (node, child) pairs or (node, child, weight) tuples.
+    // Degrees are counted first, so each adjacency list is allocated once.
+    template <typename iterator_type>
+    void insert_edges(iterator_type first, iterator_type last) { link(first, last, false); }
+
+    void reserve(size_type nodes);
     void erase(id_type);
-    void erase(const nodes_container&);
+    void erase(const std::vector<id_type>&);
     void erase(id_type, id_type);
+    id_map compact();
+
+    // Moves every node to the id remap[node]. Live nodes must be mapped to a
+    // permutation of [0, order()), erased ones are dropped as by compact.
+    void relabel(const id_map& remap);
     size_type degree(id_type node) const { return in(node).size() + out(node).size(); }
-    size_type order() const { return objs_.size() - removed_nodes_; }
-    size_type size() const;
+    size_type order() const { return objs_.size() - free_.size(); }
+    size_type size() const { return edges_; }
+    size_type capacity() const { return objs_.size(); }
     bool empty() const { return order() == 0; }
     
     const nodes_container& in(id_type node) const { return radjs_[node]; }
     const nodes_container& out(id_type node) const { return adjs_[node]; }
+    edge_range in_edges(id_type node) const { return { radjs_[node].data(), rws_[node].data(), radjs_[node].size() }; }
+    edge_range out_edges(id_type node) const { return { adjs_[node].data(), ws_[node].data(), adjs_[node].size() }; }
     
     T& operator[](id_type node) { return objs_[node]; }
     const T& operator[](id_type node) const { return objs_[node]; }
     
     template <typename search_algorithm>
-    search_iterator<search_algorithm> begin(id_type root) const { return search_iterator<search_algorithm> { *this, adjs_, root }; }
+    search_iterator<search_algorithm> begin(id_type root) const { return search_iterator<search_algorithm> { *this, false, root }; }
     
     template <typename search_algorithm>
-    search_iterator<search_algorithm> end() const { return search_iterator<search_algorithm> { *this, adjs_ }; }
+    search_iterator<search_algorithm> end() const { return search_iterator<search_algorithm> { *this, false }; }
     
     template <typename search_algorithm>
-    search_iterator<search_algorithm> rbegin(id_type root) const { return search_iterator<search_algorithm> { *this, radjs_, root }; }
+    search_iterator<search_algorithm> rbegin(id_type root) const { return search_iterator<search_algorithm> { *this, true, root }; }
     
     template <typename search_algorithm>
-    search_iterator<search_algorithm> rend() const { return search_iterator<search_algorithm> { *this, radjs_ }; }
+    search_iterator<search_algorithm> rend() const { return search_iterator<search_algorithm> { *this, true }; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> begin(id_type root, const search_algorithm& frontier) const { return search_iterator<search_algorithm> { *this, false, root, frontier }; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> end(const search_algorithm& frontier) const { return search_iterator<search_algorithm> { *this, false, null_id, frontier }; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> rbegin(id_type root, const search_algorithm& frontier) const { return search_iterator<search_algorithm> { *this, true, root, frontier }; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> rend(const search_algorithm& frontier) const { return search_iterator<search_algorithm> { *this, true, null_id, frontier }; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> begin(id_type root, traversal_workspace<search_algorithm>& workspace) const { return search_iterator<search_algorithm> { *this, false, root, workspace }; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> rbegin(id_type root, traversal_workspace<search_algorithm>& workspace) const { return search_iterator<search_algorithm> { *this, true, root, workspace }; }
+
+    // Visits that report their work to stats, see traversal_stats
+    template <typename search_algorithm, typename stats_type>
+    search_iterator<search_algorithm, stats_type> begin(id_type root, traversal_workspace<search_algorithm>& workspace, stats_type& stats) const 
+    { 
+        return search_iterator<search_algorithm, stats_type> { *this, false, root, workspace, stats }; 
+    }
+
+    template <typename search_algorithm, typename stats_type>
+    search_iterator<search_algorithm, stats_type> rbegin(id_type root, traversal_workspace<search_algorithm>& workspace, stats_type& stats) const 
+    { 
+        return search_iterator<search_algorithm, stats_type> { *this, true, root, workspace, stats }; 
+    }
     
     void edge(id_type node, id_type child, weight_type w = 1);
     weight_type weight(id_type node, id_type child) const;
-    bool is_weighted() const { return weighted_; }
+    // Always false for unweighted graphs, so that branches on them fold away
+    bool is_weighted() const { return weight_storage<V, A>::stored && weighted_; }
+    bool has_negative_weights() const { return weight_storage<V, A>::stored && negative_weights_; }
+
+    // Shortest paths from root, picking the algorithm as search_iterator does.
+    // Results are cached until the graph changes.
+    std::shared_ptr<const path> shortest_paths(id_type root) const;
+
+    // Shortest path between two nodes, as (nodes from source to target, distance).
+    // Uses a cached tree from source when there is one, a bidirectional search otherwise.
+    // A source queried twice gets its whole tree computed and cached. Ids out of range
+    // and erased nodes are unreachable: the path is empty and the distance is the max weight.
+    path_result shortest_path(id_type source, id_type target) const;
+    void set_path_cache_capacity(size_type capacity) { cache_.set_capacity(capacity); }
+    size_type version() const { return version_; }
+    memory_report memory_usage() const;
     
     edge_iterator edges_begin() const { return edge_iterator { *this, 0 }; }
     edge_iterator edges_end() const { return edge_iterator { *this }; }
@@ -218,88 +368,441 @@ public:
     node_iterator nodes_begin() const { return node_iterator { *this, 0 }; }
     node_iterator nodes_end() const { return node_iterator { *this }; }
 
-    bool is_valid(id_type node) const { return invalid_nodes_.find(node) == invalid_nodes_.end(); }
+    bool is_valid(id_type node) const { return node < objs_.size() && (live_[node / 64] >> (node % 64) & 1); }
+    allocator_type get_allocator() const { return objs_.get_allocator(); }
     
+protected:
+    template <typename iterator_type>
+    void link(iterator_type first, iterator_type last, bool symmetric);
+
+private:
+    template <typename U, typename W, typename B>
+    friend bool load(std::istream& in, graph<U, W, B>& G);
+
+    template <typename U, typename W, typename B>
+    friend class graph_builder;
+
+private:
+    template <typename erased_predicate, typename touch_predicate>
+    void unlink(const std::vector<id_type>& nodes, erased_predicate erased, touch_predicate touch);
+
+    void set_live(id_type node, bool live);
+    void reset_live(size_type n);
+    id_type next_live(id_type node) const;
+    id_type prev_live(id_type node) const;
+
+    template <typename edge_tuple>
+    static weight_type weight_of(const edge_tuple& e, std::true_type) { return static_cast<weight_type>(std::get<2>(e)); }
+
+    template <typename edge_tuple>
+    static weight_type weight_of(const edge_tuple&, std::false_type) { return 1; }
+
 private:
-    std::vector<nodes_container> adjs_;
-    std::vector<nodes_container> radjs_;
-    std::vector<std::unordered_map<id_type, weight_type>> ws_;
-    std::vector<std::unordered_map<id_type, weight_type>> rws_;
-    std::vector<value_type> objs_;
-    std::unordered_set<id_type> invalid_nodes_;
-    size_type removed_nodes_ = 0;
+    adjacency_container adjs_;
+    adjacency_container radjs_;
+    typename weight_storage<V, A>::table_type ws_;
+    typename weight_storage<V, A>::table_type rws_;
+    std::vector<value_type, A> objs_;
+    std::vector<uint64_t, typename std::allocator_traits<A>::template rebind_alloc<uint64_t>> live_;
+    nodes_container free_;
+    size_type edges_ = 0;
+    size_type version_ = 0;
     bool weighted_ = false;
+    bool negative_weights_ = false;
+    mutable path_cache cache_;
 };
 
-template <typename T, typename V>
-class undirected_graph : public graph<T, V>
+template <typename T, typename V, typename A = std::allocator<T>>
+class undirected_graph : public graph<T, V, A>
 {
 public:
-    using value_type = typename graph<T, V>::value_type;
-    using weight_type = typename graph<T, V>::weight_type;
-    using size_type = typename graph<T, V>::size_type;
-    using id_type = typename graph<T, V>::id_type;
-    using nodes_container = typename graph<T, V>::nodes_container;
+    using value_type = typename graph<T, V, A>::value_type;
+    using weight_type = typename graph<T, V, A>::weight_type;
+    using size_type = typename graph<T, V, A>::size_type;
+    using id_type = typename graph<T, V, A>::id_type;
+    using nodes_container = typename graph<T, V, A>::nodes_container;
+    using allocator_type = typename graph<T, V, A>::allocator_type;
+
+public:
+    undirected_graph() = default;
+    explicit undirected_graph(const allocator_type& alloc) : graph<T, V, A>(alloc) { }
 
 public:
     void edge(undirected_graph::id_type node, undirected_graph::id_type o, undirected_graph::weight_type w = 1)
     {
-        graph<T, V>::edge(node, o, w);
-        graph<T, V>::edge(o, node, w);
+        graph<T, V, A>::edge(node, o, w);
+        graph<T, V, A>::edge(o, node, w);
     }
 
-    const nodes_container& adjs(id_type node) const { return graph<T, V>::out(node); }
+    template <typename iterator_type>
+    void insert_edges(iterator_type first, iterator_type last) { graph<T, V, A>::link(first, last, true); }
+
+    const nodes_container& adjs(id_type node) const { return graph<T, V, A>::out(node); }
 };
 
-template <typename value_type, typename weight_type>
-using weighted_digraph = graph<value_type, weight_type>;
+template <typename value_type, typename weight_type, typename allocator_type = std::allocator<value_type>>
+using weighted_digraph = graph<value_type, weight_type, allocator_type>;
+
+template <typename value_type, typename allocator_type = std::allocator<value_type>>
+using digraph = graph<value_type, ssize_t, allocator_type>;
 
-template <typename value_type>
-using digraph = graph<value_type>;
+// Edges take no room for weights and distances are hops. Weights passed to edge() are ignored
+template <typename value_type, typename allocator_type = std::allocator<value_type>>
+using unweighted_digraph = graph<value_type, void, allocator_type>;
 
-template <typename value_type, typename weight_type>
-using weighted_undirected_graph = undirected_graph<value_type, weight_type>;
+template <typename value_type, typename weight_type, typename allocator_type = std::allocator<value_type>>
+using weighted_undirected_graph = undirected_graph<value_type, weight_type, allocator_type>;
 
-template <typename T>
-class tree : private graph<T>
+// Graph whose storage lives in an arena, e.g. arena a; arena_graph<int> G { a };
+template <typename value_type, typename weight_type = ssize_t>
+using arena_graph = graph<value_type, weight_type, arena_allocator<value_type>>;
+
+// Rooted forest. Nodes are linked to their parent, first child and siblings,
+// so a tree only stores a few ids per node and appending a child is O(1).
+// For ancestor queries, build a tree_index.
+template <typename T, typename A = std::allocator<T>>
+class tree
 {
 public:
-    using value_type = typename graph<T>::value_type;
-    using size_type = typename graph<T>::size_type;
-    using id_type = typename graph<T>::id_type;
-    using nodes_container = typename graph<T>::nodes_container;
+    using value_type = T;
+    using allocator_type = A;
+    using size_type = size_t;
+    using id_type = size_t;
+    using id_container = std::vector<id_type, typename std::allocator_traits<A>::template rebind_alloc<id_type>>;
+    using path_array = std::vector<id_type>;
+
+    static constexpr const id_type null_id = std::numeric_limits<id_type>::max();
+
+public:
+    // Children of a node, in the order they were appended.
+    class children_range
+    {
+    public:
+        class iterator
+        {
+        public:
+            iterator(const tree& G, id_type node)
+                : G_(&G), node_(node)
+            { }
+
+        public:
+            id_type operator*() const { return node_; }
+            iterator& operator++() { node_ = G_->next_sibling(node_); return *this; }
+
+            bool operator==(const iterator& other) const { return node_ == other.node_; }
+            bool operator!=(const iterator& other) const { return !(*this == other); }
+
+        private:
+            const tree* G_;
+            id_type node_;
+        };
+
+    public:
+        children_range(const tree& G, id_type first)
+            : G_(G), first_(first)
+        { }
+
+    public:
+        iterator begin() const { return { G_, first_ }; }
+        iterator end() const { return { G_, null_id }; }
+        bool empty() const { return first_ == null_id; }
+        size_type size() const;
+
+    private:
+        const tree& G_;
+        id_type first_;
+    };
 
-    using graph<T>::null_id;
+    // Preorder (dfs) or level order (bfs) visit of the subtree of root, or of root
+    // and its ancestors when reversed. No visited set is needed, as every node is
+    // reached once. The children of a node are pushed as soon as it's reached.
+    template <typename container_type>
+    class search_iterator
+    {
+    public:
+        search_iterator(const tree& G, bool reversed, id_type root = null_id)
+            : G_(&G), reversed_(reversed)
+        {
+            if (root != null_id)
+            {
+                reach(root);
+            }
+        }
+
+    public:
+        id_type operator*() const { return curr_; }
+        search_iterator& operator++();
+
+        // Path calculations, from other to this, along parent to child links
+        size_type operator-(const search_iterator& other) const;
+        path_array operator<(const search_iterator& other) const;
+        path_array operator>(const search_iterator& other) const { return other < *this; }
+
+        bool operator==(const search_iterator& other) const { return curr_ == other.curr_; }
+        bool operator!=(const search_iterator& other) const { return !(*this == other); }
+
+        // Skips the subtree of the current node
+        void prune();
+        id_type peek() const { return frontier_.empty() ? null_id : frontier_.top(); }
+
+    private:
+        void reach(id_type node);
+        void drop_pruned();
+        bool pushed_from(id_type node, id_type from) const { return reversed_ ? G_->parent(from) == node : G_->parent(node) == from; }
+
+    private:
+        const tree* G_;
+        bool reversed_;
+        container_type frontier_;
+        id_type curr_ = null_id;
+
+        // Children pushed for curr_, and the pruned nodes whose children
+        // are still in a queue frontier, with how many of them are left
+        size_type pushed_ = 0;
+        std::deque<std::pair<id_type, size_type>> pruned_;
+    };
+
+    class node_iterator
+    {
+    public:
+        node_iterator(const tree& G, id_type v = null_id)
+            : G_(G), v_(G.next_valid(v))
+        { }
+
+    public:
+        id_type operator*() const { return v_; }
+        node_iterator& operator++() { v_ = G_.next_valid(v_ + 1); return *this; }
+
+        bool operator==(const node_iterator& other) const { return v_ == other.v_; }
+        bool operator!=(const node_iterator& other) const { return !(*this == other); }
+
+    private:
+        const tree& G_;
+        id_type v_;
+    };
+
+    using edge_type = std::pair<id_type, id_type>;
+
+    // Edges as (parent, child) pairs, by increasing child.
+    class edge_iterator
+    {
+    public:
+        edge_iterator(const tree& G, id_type v = null_id)
+            : G_(G), v_(G.next_child(v))
+        { }
+
+    public:
+        edge_type operator*() const { return { G_.parent(v_), v_ }; }
+        edge_iterator& operator++() { v_ = G_.next_child(v_ + 1); return *this; }
+
+        bool operator==(const edge_iterator& other) const { return v_ == other.v_; }
+        bool operator!=(const edge_iterator& other) const { return !(*this == other); }
+
+    private:
+        const tree& G_;
+        id_type v_;
+    };
 
 public:
-    size_type order() const { return graph<T>::order(); }
-    size_type size() const { return order() > 0 ? order() - 1 : 0; }
+    tree() = default;
+    explicit tree(const allocator_type& alloc);
+
+public:
+    id_type insert(typename std::conditional<std::is_arithmetic<value_type>::value, value_type, const value_type&>::type);
 
-    id_type parent(id_type node) const { return graph<T>::in(node).size() > 0 ? graph<T>::out(node)[0] : tree<T>::null_id; }
-    const nodes_container& children(id_type node) const { return graph<T>::out(node); }
-    void append(id_type node, id_type child) { graph<T>::edge(node, child); };
+    template <typename iterator_type>
+    id_type insert(iterator_type first, iterator_type last);
 
-    using graph<T>::insert;
-    using graph<T>::erase;
-    using graph<T>::edges_begin;
-    using graph<T>::edges_end;
-    using graph<T>::nodes_begin;
-    using graph<T>::nodes_end;
+    void reserve(size_type nodes);
 
-    using graph<T>::begin;
-    using graph<T>::end;
+    // Makes child the last child of node, detaching it from its former parent.
+    // child must not be an ancestor of node.
+    void append(id_type node, id_type child);
 
-    using graph<T>::operator[];
-    using graph<T>::is_valid;
+    // Erases nodes, whose children become roots
+    void erase(id_type node);
+    void erase(const std::vector<id_type>& nodes);
+
+    // Detaches child from node, if node is its parent
+    void erase(id_type node, id_type child);
+
+    size_type order() const { return objs_.size() - free_.size(); }
+    size_type size() const { return edges_; }
+    size_type capacity() const { return objs_.size(); }
+    bool empty() const { return order() == 0; }
+
+    id_type parent(id_type node) const { return parent_[node]; }
+    id_type first_child(id_type node) const { return first_child_[node]; }
+    id_type next_sibling(id_type node) const { return next_sibling_[node]; }
+    children_range children(id_type node) const { return { *this, first_child_[node] }; }
+    bool is_root(id_type node) const { return parent_[node] == null_id; }
+
+    T& operator[](id_type node) { return objs_[node]; }
+    const T& operator[](id_type node) const { return objs_[node]; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> begin(id_type root) const { return search_iterator<search_algorithm> { *this, false, root }; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> end() const { return search_iterator<search_algorithm> { *this, false }; }
+
+    // Visits root and then its ancestors
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> rbegin(id_type root) const { return search_iterator<search_algorithm> { *this, true, root }; }
+
+    template <typename search_algorithm>
+    search_iterator<search_algorithm> rend() const { return search_iterator<search_algorithm> { *this, true }; }
+
+    edge_iterator edges_begin() const { return edge_iterator { *this, 0 }; }
+    edge_iterator edges_end() const { return edge_iterator { *this }; }
+
+    node_iterator nodes_begin() const { return node_iterator { *this, 0 }; }
+    node_iterator nodes_end() const { return node_iterator { *this }; }
+
+    bool is_valid(id_type node) const { return node < objs_.size() && valid_[node]; }
+    allocator_type get_allocator() const { return objs_.get_allocator(); }
+
+private:
+    template <typename U, typename B>
+    friend bool save(const tree<U, B>& G, std::ostream& out);
+
+    template <typename U, typename B>
+    friend bool load(std::istream& in, tree<U, B>& G);
+
+private:
+    void detach(id_type child);
+    void grow(size_type n);
+    id_type next_valid(id_type node) const;
+    id_type next_child(id_type node) const;
+
+private:
+    std::vector<value_type, A> objs_;
+    id_container parent_;
+    id_container first_child_;
+    id_container next_sibling_;
+
+    // The previous sibling, or the last one for the first child
+    id_container prev_sibling_;
+    std::vector<unsigned char, typename std::allocator_traits<A>::template rebind_alloc<unsigned char>> valid_;
+    id_container free_;
+    size_type edges_ = 0;
 };
 
-template <typename T, typename V>
-typename graph<T, V>::path bfs_distance(const graph<T, V>& G, typename graph<T, V>::id_type root);
+// Ancestry of every node of a tree, computed in O(n) from a preorder visit.
+// Answers lowest common ancestor, ancestor and subtree size queries in O(1),
+// and level ancestor ones in O(log n). It's a snapshot: changes to the tree
+// afterwards are not seen.
+class tree_index
+{
+public:
+    using size_type = size_t;
+    using id_type = size_t;
+
+    static constexpr const id_type null_id = std::numeric_limits<id_type>::max();
+
+public:
+    tree_index() = default;
+
+    template <typename T, typename A>
+    explicit tree_index(const tree<T, A>& G);
+
+public:
+    size_type depth(id_type node) const { return depth_[node]; }
+    size_type subtree_size(id_type node) const { return size_[node]; }
+
+    // Position of node in the preorder visit, where every subtree is contiguous
+    size_type preorder(id_type node) const { return pre_[node]; }
+
+    // True if ancestor is node or one of its ancestors
+    bool is_ancestor(id_type ancestor, id_type node) const { return pre_[node] - pre_[ancestor] < size_[ancestor]; }
+
+    // null_id if the nodes are in different trees of the forest
+    id_type lca(id_type u, id_type v) const;
+
+    // Ancestor of node k levels up, null_id if node is less than k levels deep
+    id_type level_ancestor(id_type node, size_type k) const;
+
+    id_type root(id_type node) const { return level_ancestor(node, depth_[node]); }
+
+private:
+    size_type min_parent(size_type first, size_type last) const;
+    size_type min_in_block(size_type first, size_type last) const;
+
+private:
+    std::vector<id_type> pre_;
+    std::vector<id_type> order_;
+    std::vector<size_type> size_;
+    std::vector<size_type> depth_;
+
+    // Preorder positions grouped by depth, in order. Level d is in [levels_[d], levels_[d + 1])
+    std::vector<size_type> by_level_;
+    std::vector<size_type> levels_;
+
+    // parents_[k] is 1 + the preorder position of the parent of order_[k], 0 for roots.
+    // Range minima come from bitmasks within blocks of 64, and a sparse table across blocks.
+    std::vector<size_type> parents_;
+    std::vector<uint64_t> masks_;
+    std::vector<std::vector<size_type>> blocks_;
+};
 
-template <typename T, typename V>
-typename graph<T, V>::path bellman_ford(const graph<T, V>& G, typename graph<T, V>::id_type root);
+enum class node_order { reverse_cuthill_mckee, degree, bfs, dfs };
+
+// Permutation of the live nodes that places nodes used together at close ids,
+// as old id -> new id (null_id for erased nodes):
+// - reverse_cuthill_mckee: BFS from low degree nodes, visiting neighbours (in and out)
+//   by increasing degree, reversed. Keeps the ids of adjacent nodes close
+// - degree: by decreasing degree, so that hubs share few cache lines
+// - bfs, dfs: order of first visit along out edges, restarting from the lowest unvisited id
+template <typename T, typename V, typename A>
+typename graph<T, V, A>::id_map node_ordering(const graph<T, V, A>& G, node_order strategy);
+
+// Relabels G with node_ordering(G, strategy) and returns the id map. Like compact,
+// it invalidates all ids and drops erased nodes.
+template <typename T, typename V, typename A>
+typename graph<T, V, A>::id_map reorder(graph<T, V, A>& G, node_order strategy = node_order::reverse_cuthill_mckee);
+
+template <typename T, typename V, typename A>
+typename graph<T, V, A>::path bfs_distance(const graph<T, V, A>& G, typename graph<T, V, A>::id_type root);
+
+template <typename T, typename V, typename A>
+typename graph<T, V, A>::path bellman_ford(const graph<T, V, A>& G, typename graph<T, V, A>::id_type root);
+
+// Same as above, reporting their work to stats (e.g. a traversal_stats)
+template <typename T, typename V, typename A, typename stats_type>
+typename std::enable_if<is_stats<stats_type>::value, typename graph<T, V, A>::path>::type bfs_distance(
+    const graph<T, V, A>& G, 
+    typename graph<T, V, A>::id_type root, 
+    stats_type& stats
+);
+
+template <typename T, typename V, typename A, typename stats_type>
+typename std::enable_if<is_stats<stats_type>::value, typename graph<T, V, A>::path>::type bellman_ford(
+    const graph<T, V, A>& G, 
+    typename graph<T, V, A>::id_type root, 
+    stats_type& stats
+);
+
+template <typename queue_type = heap::binary, typename T, typename V, typename A>
+typename graph<T, V, A>::path dijkstra(const graph<T, V, A>& G, typename graph<T, V, A>::id_type root);
+
+// Point to point searches growing from both ends, as (nodes from source to target, distance).
+// Erased or out of range endpoints are unreachable, as for graph::shortest_path.
+template <typename T, typename V, typename A>
+typename graph<T, V, A>::path_result bidirectional_bfs(
+    const graph<T, V, A>& G, 
+    typename graph<T, V, A>::id_type source, 
+    typename graph<T, V, A>::id_type target
+);
+
+template <typename queue_type = heap::binary, typename T, typename V, typename A>
+typename graph<T, V, A>::path_result bidirectional_dijkstra(
+    const graph<T, V, A>& G, 
+    typename graph<T, V, A>::id_type source, 
+    typename graph<T, V, A>::id_type target
+);
 
 #include "graph.inl"
+#include "tree.inl"
 
 } // namespace estd
 
@@ -1,321 +1,801 @@
-template <typename T, typename V>
-inline typename graph<T, V>::id_type graph<T, V>::insert(
+template <typename T, typename V, typename A>
+constexpr const typename graph<T, V, A>::id_type graph<T, V, A>::null_id;
+
+template <typename T, typename V, typename A>
+inline graph<T, V, A>::graph(const allocator_type& alloc)
+    : adjs_(alloc), radjs_(alloc), ws_(alloc), rws_(alloc), objs_(alloc), live_(alloc), free_(alloc)
+{ }
+
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::id_type graph<T, V, A>::insert(
     typename std::conditional<std::is_arithmetic<value_type>::value, value_type, 
     const value_type&>::type val
 )
 {
-    if (!invalid_nodes_.empty())
+    version_++;
+
+    if (!free_.empty())
     {
-        auto it = invalid_nodes_.cbegin();
-        auto node = *it;
-        invalid_nodes_.erase(it);
+        id_type node = free_.back();
+        free_.pop_back();
         objs_[node] = val;
-        removed_nodes_--;
+        set_live(node, true);
 
         return node;
     }
 
-    adjs_.emplace_back();
-    radjs_.emplace_back();
-    ws_.emplace_back();
-    rws_.emplace_back();
+    adjs_.emplace_back(get_allocator());
+    radjs_.emplace_back(get_allocator());
+    ws_.emplace_back(get_allocator());
+    rws_.emplace_back(get_allocator());
     objs_.push_back(val);
+    set_live(objs_.size() - 1, true);
     
     return objs_.size() - 1;
 }
 
-template <typename T, typename V>
-inline void graph<T, V>::erase(id_type node)
+template <typename T, typename V, typename A>
+template <typename iterator_type>
+inline typename graph<T, V, A>::id_type graph<T, V, A>::insert(iterator_type first, iterator_type last)
+{
+    version_++;
+
+    id_type start = objs_.size();
+    objs_.insert(objs_.end(), first, last);
+
+    adjs_.resize(objs_.size(), nodes_container(get_allocator()));
+    radjs_.resize(objs_.size(), nodes_container(get_allocator()));
+    ws_.resize(objs_.size(), weights_container(get_allocator()));
+    rws_.resize(objs_.size(), weights_container(get_allocator()));
+
+    for (id_type node = start; node < objs_.size(); ++node)
+    {
+        set_live(node, true);
+    }
+
+    return start;
+}
+
+template <typename T, typename V, typename A>
+inline void graph<T, V, A>::reserve(size_type nodes)
 {
-    erase(nodes_container { node });
+    adjs_.reserve(nodes);
+    radjs_.reserve(nodes);
+    ws_.reserve(nodes);
+    rws_.reserve(nodes);
+    objs_.reserve(nodes);
+    live_.reserve((nodes + 63) / 64);
 }
 
-template <typename T, typename V>
-inline void graph<T, V>::erase(const nodes_container& nodes)
+template <typename T, typename V, typename A>
+inline void graph<T, V, A>::set_live(id_type node, bool live)
 {
-    auto repop_nodes = [] (std::vector<nodes_container>& dst, const nodes_container& nodes) mutable {
-        for (auto node = 0; node < dst.size(); ++node)
+    if (node / 64 >= live_.size())
+    {
+        live_.resize(node / 64 + 1, 0);
+    }
+
+    if (live)
+    {
+        live_[node / 64] |= uint64_t { 1 } << (node % 64);
+    }
+    else
+    {
+        live_[node / 64] &= ~(uint64_t { 1 } << (node % 64));
+    }
+}
+
+// Bit scans over the liveness bitmap, skipping 64 dead nodes at a time
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::id_type graph<T, V, A>::next_live(id_type node) const
+{
+    if (node >= objs_.size())
+    {
+        return graph<T, V, A>::null_id;
+    }
+
+    size_t word = node / 64;
+    uint64_t bits = live_[word] & (~uint64_t { 0 } << (node % 64));
+
+    while (bits == 0)
+    {
+        if (++word == live_.size())
         {
-            if (std::find(nodes.begin(), nodes.end(), node) != nodes.end())
-            {
-                dst[node].clear();
-            }
+            return graph<T, V, A>::null_id;
         }
-        
-        for (auto k = 0; k < dst.size(); ++k)
+
+        bits = live_[word];
+    }
+
+#if defined(__GNUC__) || defined(__clang__)
+    id_type found = word * 64 + __builtin_ctzll(bits);
+#else
+    id_type found = word * 64;
+
+    for (; !(bits & 1); bits >>= 1)
+    {
+        ++found;
+    }
+#endif
+
+    return found < objs_.size() ? found : graph<T, V, A>::null_id;
+}
+
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::id_type graph<T, V, A>::prev_live(id_type node) const
+{
+    if (objs_.empty() || node == graph<T, V, A>::null_id)
+    {
+        return graph<T, V, A>::null_id;
+    }
+
+    node = std::min<id_type>(node, objs_.size() - 1);
+
+    size_t word = node / 64;
+    uint64_t bits = live_[word] & (~uint64_t { 0 } >> (63 - node % 64));
+
+    while (bits == 0)
+    {
+        if (word-- == 0)
         {
-            nodes_container& src = dst[k];
-            nodes_container tmp;
+            return graph<T, V, A>::null_id;
+        }
 
-            for (auto node : src)
-            {
-                if (std::find(nodes.begin(), nodes.end(), node) != nodes.end())
-                {
-                    continue;
-                }
+        bits = live_[word];
+    }
 
-                tmp.push_back(node);
-            }
+#if defined(__GNUC__) || defined(__clang__)
+    return word * 64 + 63 - __builtin_clzll(bits);
+#else
+    id_type found = word * 64 + 63;
+
+    for (; !(bits >> 63); bits <<= 1)
+    {
+        --found;
+    }
+
+    return found;
+#endif
+}
+
+template <typename T, typename V, typename A>
+template <typename iterator_type>
+inline void graph<T, V, A>::link(iterator_type first, iterator_type last, bool symmetric)
+{
+    using edge_tuple = typename std::iterator_traits<iterator_type>::value_type;
+    using has_weight = std::integral_constant<bool, (std::tuple_size<edge_tuple>::value > 2)>;
+
+    std::vector<size_type> out_degree(objs_.size(), 0);
+    std::vector<size_type> in_degree(objs_.size(), 0);
+    size_type count = 0;
+
+    for (iterator_type it = first; it != last; ++it)
+    {
+        id_type node = std::get<0>(*it);
+        id_type child = std::get<1>(*it);
 
-            src = std::move(tmp);
+        out_degree[node]++;
+        in_degree[child]++;
+        count++;
+
+        if (symmetric)
+        {
+            out_degree[child]++;
+            in_degree[node]++;
+            count++;
+        }
+    }
+
+    for (id_type node = 0; node < objs_.size(); ++node)
+    {
+        if (out_degree[node] > 0)
+        {
+            adjs_[node].reserve(adjs_[node].size() + out_degree[node]);
+            ws_[node].reserve(ws_[node].size() + out_degree[node]);
+        }
+
+        if (in_degree[node] > 0)
+        {
+            radjs_[node].reserve(radjs_[node].size() + in_degree[node]);
+            rws_[node].reserve(rws_[node].size() + in_degree[node]);
+        }
+    }
+
+    auto add = [this] (id_type node, id_type child, weight_type w) {
+        adjs_[node].push_back(child);
+        radjs_[child].push_back(node);
+        ws_[node].push_back(w);
+        rws_[child].push_back(w);
+
+        if (weight_storage<V, A>::stored && w != 1)
+        {
+            weighted_ = true;
+        }
+
+        if (weight_storage<V, A>::stored && w < weight_type {})
+        {
+            negative_weights_ = true;
         }
     };
 
-    auto repop_weights = [] (std::vector<std::unordered_map<id_type, weight_type>>& dst, const nodes_container& nodes) mutable {
-        for (auto node = 0; node < dst.size(); ++node)
+    for (; first != last; ++first)
+    {
+        id_type node = std::get<0>(*first);
+        id_type child = std::get<1>(*first);
+        weight_type w = weight_of(*first, has_weight {});
+
+        add(node, child, w);
+
+        if (symmetric)
+        {
+            add(child, node, w);
+        }
+    }
+
+    edges_ += count;
+    version_++;
+}
+
+template <typename T, typename V, typename A>
+inline void graph<T, V, A>::erase(id_type node)
+{
+    if (!is_valid(node))
+    {
+        return;
+    }
+
+    version_++;
+
+    unlink(
+        std::vector<id_type> { node },
+        [node] (id_type other) { return other == node; },
+        [] (id_type, unsigned char) { return true; }
+    );
+}
+
+template <typename T, typename V, typename A>
+inline void graph<T, V, A>::erase(const std::vector<id_type>& nodes)
+{
+    std::vector<bool> erased(objs_.size(), false);
+    std::vector<unsigned char> touched(objs_.size(), 0);
+    std::vector<id_type> valid_nodes;
+
+    valid_nodes.reserve(nodes.size());
+
+    for (id_type node : nodes)
+    {
+        if (is_valid(node) && !erased[node])
         {
-            if (std::find(nodes.begin(), nodes.end(), node) != nodes.end())
+            erased[node] = true;
+            valid_nodes.push_back(node);
+        }
+    }
+
+    version_++;
+
+    unlink(
+        valid_nodes,
+        [&erased] (id_type other) { return erased[other]; },
+        [&touched] (id_type other, unsigned char direction) {
+            bool first = !(touched[other] & direction);
+            touched[other] |= direction;
+            return first;
+        }
+    );
+}
+
+template <typename T, typename V, typename A>
+template <typename erased_predicate, typename touch_predicate>
+inline void graph<T, V, A>::unlink(const std::vector<id_type>& nodes, erased_predicate erased, touch_predicate touch)
+{
+    auto drop = [&erased] (nodes_container& adjs, weights_container& ws) -> size_type {
+        size_t k = 0;
+
+        for (size_t idx = 0; idx < adjs.size(); ++idx)
+        {
+            if (!erased(adjs[idx]))
             {
-                dst[node].clear();
+                adjs[k] = adjs[idx];
+                ws[k] = ws[idx];
+                ++k;
             }
         }
 
-        for (auto k = 0; k < dst.size(); ++k)
+        size_type dropped = adjs.size() - k;
+        adjs.resize(k);
+        ws.resize(k);
+
+        return dropped;
+    };
+
+    for (id_type node : nodes)
+    {
+        edges_ -= adjs_[node].size();
+
+        for (id_type child : adjs_[node])
         {
-            std::unordered_map<id_type, weight_type>& src = dst[k];
-            std::unordered_map<id_type, weight_type> tmp;
+            if (!erased(child) && touch(child, 1))
+            {
+                drop(radjs_[child], rws_[child]);
+            }
+        }
 
-            for (auto& pair : src)
+        for (id_type parent : radjs_[node])
+        {
+            if (!erased(parent) && touch(parent, 2))
             {
-                auto node = pair.first;
+                edges_ -= drop(adjs_[parent], ws_[parent]);
+            }
+        }
+    }
 
-                if (std::find(nodes.begin(), nodes.end(), node) != nodes.end())
-                {
-                    continue;
-                }
+    for (id_type node : nodes)
+    {
+        nodes_container(get_allocator()).swap(adjs_[node]);
+        nodes_container(get_allocator()).swap(radjs_[node]);
+        weights_container(get_allocator()).swap(ws_[node]);
+        weights_container(get_allocator()).swap(rws_[node]);
+        objs_[node] = value_type {};
+        set_live(node, false);
+        free_.push_back(node);
+    }
+}
 
-                tmp.insert(pair);
-            }
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::id_map graph<T, V, A>::compact()
+{
+    version_++;
+
+    id_map remap(objs_.size(), graph<T, V, A>::null_id);
+    id_type next = 0;
 
-            src = std::move(tmp);
+    for (id_type node = 0; node < objs_.size(); ++node)
+    {
+        if (is_valid(node))
+        {
+            remap[node] = next++;
+        }
+    }
+
+    auto renumber = [&remap] (nodes_container& adjs) {
+        for (id_type& node : adjs)
+        {
+            node = remap[node];
         }
     };
 
-    size_type sz = order();
+    for (id_type node = 0; node < objs_.size(); ++node)
+    {
+        id_type dst = remap[node];
+
+        if (dst == graph<T, V, A>::null_id)
+        {
+            continue;
+        }
+
+        renumber(adjs_[node]);
+        renumber(radjs_[node]);
+
+        if (dst != node)
+        {
+            adjs_[dst] = std::move(adjs_[node]);
+            radjs_[dst] = std::move(radjs_[node]);
+            ws_[dst] = std::move(ws_[node]);
+            rws_[dst] = std::move(rws_[node]);
+            objs_[dst] = std::move(objs_[node]);
+        }
+    }
+
+    adjs_.erase(adjs_.begin() + next, adjs_.end());
+    radjs_.erase(radjs_.begin() + next, radjs_.end());
+    ws_.erase(ws_.begin() + next, ws_.end());
+    rws_.erase(rws_.begin() + next, rws_.end());
+    objs_.erase(objs_.begin() + next, objs_.end());
+    reset_live(next);
+
+    return remap;
+}
+
+template <typename T, typename V, typename A>
+inline void graph<T, V, A>::relabel(const id_map& remap)
+{
+    version_++;
 
-    for (auto node = 0; node < objs_.size(); ++node)
+    size_type n = order();
+    adjacency_container adjs(n, nodes_container(get_allocator()), get_allocator());
+    adjacency_container radjs(n, nodes_container(get_allocator()), get_allocator());
+    decltype(ws_) ws(n, weights_container(get_allocator()), get_allocator());
+    decltype(rws_) rws(n, weights_container(get_allocator()), get_allocator());
+    decltype(objs_) objs(n, value_type {}, get_allocator());
+
+    auto renumber = [&remap] (nodes_container& list) {
+        for (id_type& node : list)
+        {
+            node = remap[node];
+        }
+    };
+
+    for (id_type node = 0; node < objs_.size(); ++node)
     {
-        if (std::find(nodes.begin(), nodes.end(), node) != nodes.end())
+        if (!is_valid(node))
         {
-            objs_[node] = value_type {};
-            sz--;
+            continue;
         }
+
+        id_type dst = remap[node];
+
+        renumber(adjs_[node]);
+        renumber(radjs_[node]);
+
+        adjs[dst] = std::move(adjs_[node]);
+        radjs[dst] = std::move(radjs_[node]);
+        ws[dst] = std::move(ws_[node]);
+        rws[dst] = std::move(rws_[node]);
+        objs[dst] = std::move(objs_[node]);
     }
 
-    removed_nodes_ += order() - sz;
+    adjs_.swap(adjs);
+    radjs_.swap(radjs);
+    ws_.swap(ws);
+    rws_.swap(rws);
+    objs_.swap(objs);
+    reset_live(n);
+}
 
-    repop_nodes(adjs_, nodes);
-    repop_nodes(radjs_, nodes);
-    repop_weights(ws_, nodes);
-    repop_weights(rws_, nodes);
+template <typename T, typename V, typename A>
+inline void graph<T, V, A>::reset_live(size_type n)
+{
+    free_.clear();
+    live_.assign((n + 63) / 64, ~uint64_t { 0 });
 
-    for (auto node : nodes)
+    if (n % 64 != 0)
     {
-        invalid_nodes_.insert(node);
+        live_.back() = (uint64_t { 1 } << (n % 64)) - 1;
     }
 }
 
-template <typename T, typename V>
-void graph<T, V>::erase(id_type first, id_type second)
+template <typename T, typename V, typename A>
+void graph<T, V, A>::erase(id_type first, id_type second)
 {
+    version_++;
+
     auto it = std::find(adjs_[first].begin(), adjs_[first].end(), second);
 
     if (it != adjs_[first].end())
     {
+        ws_[first].erase(ws_[first].begin() + (it - adjs_[first].begin()));
         adjs_[first].erase(it);
+        edges_--;
     }
     
     auto rit = std::find(radjs_[second].begin(), radjs_[second].end(), first);
 
     if (rit != radjs_[second].end())
     {
+        rws_[second].erase(rws_[second].begin() + (rit - radjs_[second].begin()));
         radjs_[second].erase(rit);
     }
 }
 
-template <typename T, typename V>
-inline void graph<T, V>::edge(id_type node, id_type child, weight_type w)
+template <typename T, typename V, typename A>
+inline void graph<T, V, A>::edge(id_type node, id_type child, weight_type w)
 {
+    version_++;
+    edges_++;
     adjs_[node].push_back(child);
     radjs_[child].push_back(node);
-    ws_[node][child] = w;
-    rws_[child][node] = w;
+    ws_[node].push_back(w);
+    rws_[child].push_back(w);
     
-    if (w != 1)
+    // Unweighted graphs drop w, so it mustn't turn them into weighted ones
+    if (weight_storage<V, A>::stored && w != 1)
     {
         weighted_ = true;
     }
+
+    if (weight_storage<V, A>::stored && w < weight_type {})
+    {
+        negative_weights_ = true;
+    }
+}
+
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::weight_type graph<T, V, A>::weight(id_type node, id_type child) const
+{
+    return sssp::weight(*this, node, child);
 }
 
-template <typename T, typename V>
-inline typename graph<T, V>::weight_type graph<T, V>::weight(id_type node, id_type child) const
+template <typename T, typename V, typename A>
+inline std::shared_ptr<const typename graph<T, V, A>::path> graph<T, V, A>::shortest_paths(id_type root) const
 {
-    return node < ws_.size() && ws_[node].find(child) != ws_[node].end() ?
-        ws_[node].at(child)
-        : std::numeric_limits<graph<T, V>::weight_type>::max()
+    using algorithm = typename path_cache::algorithm;
+
+    algorithm alg = !is_weighted() ? algorithm::bfs 
+        : has_negative_weights() ? algorithm::bellman_ford 
+        : algorithm::dijkstra
     ;
+
+    std::shared_ptr<const path> paths = cache_.find(root, alg, version_);
+
+    if (paths)
+    {
+        return paths;
+    }
+
+    switch (alg)
+    {
+        case algorithm::bfs:
+            paths = std::make_shared<const path>(bfs_distance(*this, root));
+            break;
+        case algorithm::bellman_ford:
+            paths = std::make_shared<const path>(bellman_ford(*this, root));
+            break;
+        case algorithm::dijkstra:
+            paths = std::make_shared<const path>(dijkstra<heap::preferred<weight_type>>(*this, root));
+            break;
+    }
+
+    cache_.store(root, alg, version_, paths);
+    return paths;
 }
 
-template <typename T, typename V>
-inline size_t graph<T, V>::size() const
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::path_result graph<T, V, A>::shortest_path(id_type source, id_type target) const
 {
-    size_t t = 0;
-    
-    for (id_type node = 0; node < adjs_.size(); ++node)
+    using algorithm = typename path_cache::algorithm;
+
+    if (!is_valid(source) || !is_valid(target))
     {
-        t += adjs_[node].size();
+        return { {}, std::numeric_limits<weight_type>::max() };
     }
-    
-    return t;
+
+    algorithm alg = !is_weighted() ? algorithm::bfs 
+        : has_negative_weights() ? algorithm::bellman_ford 
+        : algorithm::dijkstra
+    ;
+
+    std::shared_ptr<const path> paths = cache_.find(source, alg, version_);
+
+    if (!paths && (alg == algorithm::bellman_ford || cache_.missed_before(source, alg, version_)))
+    {
+        paths = shortest_paths(source);
+    }
+
+    if (paths)
+    {
+        return { paths->path_to(target), paths->distance_to(target) };
+    }
+
+    if (alg == algorithm::bfs)
+    {
+        return bidirectional_bfs(*this, source, target);
+    }
+
+    return bidirectional_dijkstra<heap::preferred<weight_type>>(*this, source, target);
 }
 
-template <typename T, typename V>
-template <typename container_type>
-void graph<T, V>::search_iterator<container_type>::rewind()
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::path_cache& graph<T, V, A>::path_cache::operator=(const path_cache& other)
 {
-    curr_ = root_;
-    frontier_.clear();
-    E_.clear();
-    prune_ = false;
-    step();
+    if (this != &other)
+    {
+        size_type capacity = other.capacity();
+        std::lock_guard<std::mutex> lock { mutex_ };
+        entries_.clear();
+        misses_.clear();
+        capacity_ = capacity;
+    }
+
+    return *this;
 }
 
-template <typename T, typename V>
-template <typename container_type>
-inline void graph<T, V>::search_iterator<container_type>::step()
+template <typename T, typename V, typename A>
+inline std::shared_ptr<const typename graph<T, V, A>::path> graph<T, V, A>::path_cache::find(id_type root, algorithm alg, size_type version) const
 {
-    curr_ = frontier_.top();
-    frontier_.pop();
-    E_.insert(curr_);
-    
-    if (curr_ != graph<T, V>::null_id && !prune_)
+    std::lock_guard<std::mutex> lock { mutex_ };
+    std::shared_ptr<const path> found;
+
+    entries_.erase(
+        std::remove_if(entries_.begin(), entries_.end(), [version] (const entry& e) { return e.version != version; }),
+        entries_.end()
+    );
+
+    for (entry& e : entries_)
     {
-        for (id_type child : children_[curr_])
+        if (e.root == root && e.alg == alg)
         {
-            if (E_.find(child) != E_.end())
-            {
-                continue;
-            }
-            
-            frontier_.push(child);
+            e.last_use = ++clock_;
+            found = e.paths;
+            break;
         }
     }
-    
-    prune_ = false;
+
+    return found;
 }
 
-template <typename T, typename V>
-template <typename container_type>
-inline typename graph<T, V>::template search_iterator<container_type>& graph<T, V>::search_iterator<container_type>::operator++()
+template <typename T, typename V, typename A>
+inline void graph<T, V, A>::path_cache::store(id_type root, algorithm alg, size_type version, std::shared_ptr<const path> paths)
 {
-    if (frontier_.empty())
+    std::lock_guard<std::mutex> lock { mutex_ };
+
+    if (capacity_ == 0)
     {
-        curr_ = graph<T, V>::null_id;
+        return;
     }
-    else
+
+    if (entries_.size() >= capacity_)
     {
-        step();
+        auto lru = std::min_element(entries_.begin(), entries_.end(), [] (const entry& a, const entry& b) { 
+            return a.last_use < b.last_use; 
+        });
+
+        entries_.erase(lru);
     }
-    
-    return *this;
-}
 
-template <typename T, typename V>
-template <typename container_type>
-inline typename graph<T, V>::weight_type graph<T, V>::search_iterator<container_type>::operator-(const search_iterator& other) const
-{
-    return (other > G_).distance_to(curr_);
+    entries_.push_back({ root, alg, version, std::move(paths), ++clock_ });
 }
 
-template <typename T, typename V>
-template <typename container_type>
-inline typename graph<T, V>::nodes_container graph<T, V>::search_iterator<container_type>::operator<(const search_iterator& other) const
+template <typename T, typename V, typename A>
+inline bool graph<T, V, A>::path_cache::missed_before(id_type root, algorithm alg, size_type version)
 {
-    if (*other == graph<T, V>::null_id)
+    std::lock_guard<std::mutex> lock { mutex_ };
+
+    if (capacity_ == 0)
     {
-        return {};
+        return false;
     }
 
-    auto path = other > G_;
-    return path.path_to(curr_);
+    for (entry& e : misses_)
+    {
+        if (e.root == root && e.alg == alg && e.version == version)
+        {
+            return true;
+        }
+    }
+
+    if (misses_.size() >= capacity_)
+    {
+        misses_.erase(misses_.begin());
+    }
+
+    misses_.push_back({ root, alg, version, nullptr, 0 });
+    return false;
 }
 
-template <typename T, typename V>
-template <typename container_type>
-inline typename graph<T, V>::path graph<T, V>::search_iterator<container_type>::operator>(const graph<T, V>& G) const
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::size_type graph<T, V, A>::path_cache::memory_usage() const
 {
-    if (curr_ == graph<T, V>::null_id)
+    std::lock_guard<std::mutex> lock { mutex_ };
+    size_type bytes = (entries_.capacity() + misses_.capacity()) * sizeof(entry);
+
+    for (const entry& e : entries_)
     {
-        return {};
+        bytes += e.paths->memory_usage();
     }
-    
-    if (G_.is_weighted())
+
+    return bytes;
+}
+
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::memory_report graph<T, V, A>::memory_usage() const
+{
+    auto lists = [] (const adjacency_container& adjs) {
+        size_type bytes = adjs.capacity() * sizeof(nodes_container);
+
+        for (const nodes_container& adj : adjs)
+        {
+            bytes += adj.capacity() * sizeof(id_type);
+        }
+
+        return bytes;
+    };
+
+    memory_report report;
+
+    report.adjs = lists(adjs_);
+    report.radjs = lists(radjs_);
+    report.weights = (ws_.capacity() + rws_.capacity()) * sizeof(weights_container);
+
+    for (id_type node = 0; node < ws_.size(); ++node)
     {
-        return bellman_ford(G_, curr_);
+        report.weights += (ws_[node].capacity() + rws_[node].capacity()) * sizeof(weight_type);
     }
 
-    return bfs_distance(G_, curr_);
+    report.objs = objs_.capacity() * sizeof(value_type);
+
+    report.liveness = live_.capacity() * sizeof(uint64_t) + free_.capacity() * sizeof(id_type);
+
+    report.path_cache = cache_.memory_usage();
+
+    return report;
+}
+
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::size_type graph<T, V, A>::path_cache::capacity() const
+{
+    std::lock_guard<std::mutex> lock { mutex_ };
+    return capacity_;
 }
 
-#define NODE_ITER_OP(slide) while (!G_.is_valid(v_) && v_ < G_.order()) slide; if (v_ >= G_.order()) v_ = graph<T, V>::null_id; return *this
+template <typename T, typename V, typename A>
+inline void graph<T, V, A>::path_cache::set_capacity(size_type capacity)
+{
+    std::lock_guard<std::mutex> lock { mutex_ };
+    capacity_ = capacity;
+
+    while (entries_.size() > capacity_)
+    {
+        auto lru = std::min_element(entries_.begin(), entries_.end(), [] (const entry& a, const entry& b) { 
+            return a.last_use < b.last_use; 
+        });
+
+        entries_.erase(lru);
+    }
+}
 
-template <typename T, typename V>
-inline typename graph<T, V>::node_iterator& graph<T, V>::node_iterator::operator++()
+template <typename T, typename V, typename A>
+inline void graph<T, V, A>::path_cache::clear()
 {
-    ++v_;
-    NODE_ITER_OP(++v_);
+    std::lock_guard<std::mutex> lock { mutex_ };
+    entries_.clear();
+    misses_.clear();
 }
 
-template <typename T, typename V>
-inline typename graph<T, V>::node_iterator& graph<T, V>::node_iterator::operator--()
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::node_iterator& graph<T, V, A>::node_iterator::operator++()
 {
-    --v_;
-    NODE_ITER_OP(--v_);
+    v_ = v_ == graph<T, V, A>::null_id ? v_ : G_.next_live(v_ + 1);
+    return *this;
 }
 
-template <typename T, typename V>
-inline typename graph<T, V>::node_iterator& graph<T, V>::node_iterator::operator+(size_t n)
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::node_iterator& graph<T, V, A>::node_iterator::operator--()
 {
-    v_ += n;
-    NODE_ITER_OP(++v_);
+    v_ = v_ == graph<T, V, A>::null_id ? G_.prev_live(G_.capacity()) : v_ == 0 ? graph<T, V, A>::null_id : G_.prev_live(v_ - 1);
+    return *this;
 }
 
-template <typename T, typename V>
-inline typename graph<T, V>::node_iterator& graph<T, V>::node_iterator::operator-(size_t n)
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::node_iterator& graph<T, V, A>::node_iterator::operator+(size_t n)
 {
-    v_ -= n;
-    NODE_ITER_OP(++v_);
+    v_ = v_ == graph<T, V, A>::null_id ? v_ : G_.next_live(v_ + n);
+    return *this;
 }
 
-#undef NODE_ITER_OP
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::node_iterator& graph<T, V, A>::node_iterator::operator-(size_t n)
+{
+    v_ = v_ == graph<T, V, A>::null_id || n > v_ ? graph<T, V, A>::null_id : G_.next_live(v_ - n);
+    return *this;
+}
 
-template <typename T, typename V>
-inline bool graph<T, V>::edge_iterator::ensure_validity()
+template <typename T, typename V, typename A>
+inline bool graph<T, V, A>::edge_iterator::ensure_validity()
 {
     if (it_ == G_.nodes_end())
     {
-        u_ = graph<T, V>::null_id;
-        v_ = graph<T, V>::null_id;
+        u_ = graph<T, V, A>::null_id;
+        v_ = graph<T, V, A>::null_id;
         return false;
     }
 
     return true;
 }
 
-template <typename T, typename V>
-inline typename graph<T, V>::edge_iterator& graph<T, V>::edge_iterator::operator++()
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::edge_iterator& graph<T, V, A>::edge_iterator::operator++()
 {
-    if (!ensure_validity())
-    {
-        return *this;
-    }
-
-    if (u_ != graph<T, V>::null_id && adjs_idx_ < G_.out(u_).size())
+    if (u_ != graph<T, V, A>::null_id && adjs_idx_ < G_.out(u_).size())
     {
         v_ = G_.out(u_)[adjs_idx_++];
     }
     else
     {
+        if (!ensure_validity())
+        {
+            return *this;
+        }
+
         u_ = *it_;
 
         while (G_.out(u_).empty())
@@ -339,13 +819,18 @@ inline typename graph<T, V>::edge_iterator& graph<T, V>::edge_iterator::operator
     return *this;
 }
 
-template <typename T, typename V>
-inline typename graph<T, V>::path_array graph<T, V>::path::path_to(typename graph<T, V>::id_type node) const
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::path_array graph<T, V, A>::path::path_to(typename graph<T, V, A>::id_type node) const
 {
-    typename graph<T, V>::path_array p;
-    typename graph<T, V>::id_type v = node;
+    typename graph<T, V, A>::path_array p;
+    typename graph<T, V, A>::id_type v = node;
+
+    if (node >= distances_.size() || distances_[node] == std::numeric_limits<weight_type>::max())
+    {
+        return p;
+    }
         
-    while (v != graph<T, V>::null_id)
+    while (v != graph<T, V, A>::null_id)
     {
         p.push_back(v);
         v = parents_[v];
@@ -360,61 +845,347 @@ inline typename graph<T, V>::path_array graph<T, V>::path::path_to(typename grap
     return p;
 }
 
-template <typename T, typename V>
-inline typename graph<T, V>::path bfs_distance(const graph<T, V>& G, typename graph<T, V>::id_type root)
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::id_map node_ordering(const graph<T, V, A>& G, node_order strategy)
 {
-    std::vector<typename graph<T, V>::weight_type> level(G.order());
-    std::vector<typename graph<T, V>::id_type> p(G.order());
+    using id_type = typename graph<T, V, A>::id_type;
+
+    auto by_degree = [&G] (id_type a, id_type b) { return G.degree(a) < G.degree(b); };
+    bool rcm = strategy == node_order::reverse_cuthill_mckee;
 
-    level[root] = 0;
-    p[root] = graph<T, V>::null_id;
+    // order[k] is the node that gets id k
+    std::vector<id_type> order;
+    std::vector<id_type> roots;
 
-    for (
-        auto it = G.template begin<estd::search_algorithm::bfs>(root); 
-        it != G.template end<estd::search_algorithm::bfs>(); 
-        ++it
-    )
-        for (typename graph<T, V>::id_type child : G.out(*it))
+    order.reserve(G.order());
+    roots.reserve(G.order());
+
+    for (auto it = G.nodes_begin(); it != G.nodes_end(); ++it)
+    {
+        roots.push_back(*it);
+    }
+
+    if (strategy == node_order::degree)
+    {
+        order = std::move(roots);
+        std::stable_sort(order.begin(), order.end(), [&by_degree] (id_type a, id_type b) { return by_degree(b, a); });
+    }
+    else
+    {
+        std::vector<bool> seen(G.capacity(), false);
+        std::vector<id_type> next;
+
+        if (rcm)
         {
-            level[child] = level[*it] + 1;
-            p[child] = *it;
+            std::stable_sort(roots.begin(), roots.end(), by_degree);
         }
 
-    return typename graph<T, V>::path {
-        std::move(p),
-        std::move(level),
-        root
-    };
+        for (id_type root : roots)
+        {
+            if (seen[root])
+            {
+                continue;
+            }
+
+            if (strategy == node_order::dfs)
+            {
+                next.assign(1, root);
+
+                while (!next.empty())
+                {
+                    id_type node = next.back();
+                    next.pop_back();
+
+                    if (seen[node])
+                    {
+                        continue;
+                    }
+
+                    seen[node] = true;
+                    order.push_back(node);
+                    next.insert(next.end(), G.out(node).rbegin(), G.out(node).rend());
+                }
+
+                continue;
+            }
+
+            seen[root] = true;
+            order.push_back(root);
+
+            for (size_t head = order.size() - 1; head < order.size(); ++head)
+            {
+                id_type node = order[head];
+                next.clear();
+
+                for (id_type child : G.out(node))
+                {
+                    if (!seen[child])
+                    {
+                        seen[child] = true;
+                        next.push_back(child);
+                    }
+                }
+
+                if (!rcm)
+                {
+                    order.insert(order.end(), next.begin(), next.end());
+                    continue;
+                }
+
+                for (id_type parent : G.in(node))
+                {
+                    if (!seen[parent])
+                    {
+                        seen[parent] = true;
+                        next.push_back(parent);
+                    }
+                }
+
+                std::stable_sort(next.begin(), next.end(), by_degree);
+                order.insert(order.end(), next.begin(), next.end());
+            }
+        }
+
+        if (rcm)
+        {
+            std::reverse(order.begin(), order.end());
+        }
+    }
+
+    typename graph<T, V, A>::id_map remap(G.capacity(), graph<T, V, A>::null_id);
+
+    for (id_type idx = 0; idx < order.size(); ++idx)
+    {
+        remap[order[idx]] = idx;
+    }
+
+    return remap;
+}
+
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::id_map reorder(graph<T, V, A>& G, node_order strategy)
+{
+    typename graph<T, V, A>::id_map remap = node_ordering(G, strategy);
+    G.relabel(remap);
+
+    return remap;
 }
 
-template <typename T, typename V>
-inline typename graph<T, V>::path bellman_ford(const graph<T, V>& G, typename graph<T, V>::id_type root)
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::path bfs_distance(const graph<T, V, A>& G, typename graph<T, V, A>::id_type root)
 {
-    std::vector<typename graph<T, V>::weight_type> d(G.order());
-    std::vector<typename graph<T, V>::id_type> p(G.order());
+    null_stats stats;
+    return bfs_distance(G, root, stats);
+}
 
-    std::fill_n(d.begin(), G.order(), std::numeric_limits<typename graph<T, V>::weight_type>::max());
-    typename graph<T, V>::id_type null_id = graph<T, V>::null_id;
-    std::fill_n(p.begin(), G.order(), null_id);
+template <typename T, typename V, typename A, typename stats_type>
+inline typename std::enable_if<is_stats<stats_type>::value, typename graph<T, V, A>::path>::type bfs_distance(
+    const graph<T, V, A>& G, 
+    typename graph<T, V, A>::id_type root, 
+    stats_type& stats
+)
+{
+    return sssp::bfs(G, root, stats);
+}
+
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::path bellman_ford(const graph<T, V, A>& G, typename graph<T, V, A>::id_type root)
+{
+    null_stats stats;
+    return bellman_ford(G, root, stats);
+}
 
-    d[root] = 0;
+template <typename T, typename V, typename A, typename stats_type>
+inline typename std::enable_if<is_stats<stats_type>::value, typename graph<T, V, A>::path>::type bellman_ford(
+    const graph<T, V, A>& G, 
+    typename graph<T, V, A>::id_type root, 
+    stats_type& stats
+)
+{
+    return sssp::bellman_ford(G, root, stats);
+}
+
+template <typename queue_type, typename T, typename V, typename A>
+inline typename graph<T, V, A>::path dijkstra(const graph<T, V, A>& G, typename graph<T, V, A>::id_type root)
+{
+    return sssp::dijkstra<queue_type>(G, root);
+}
+
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::path_result bidirectional_bfs(
+    const graph<T, V, A>& G, 
+    typename graph<T, V, A>::id_type source, 
+    typename graph<T, V, A>::id_type target
+)
+{
+    using id_type = typename graph<T, V, A>::id_type;
+    using weight_type = typename graph<T, V, A>::weight_type;
+    using label = std::pair<id_type, weight_type>;
+
+    const weight_type inf = std::numeric_limits<weight_type>::max();
+
+    if (!G.is_valid(source) || !G.is_valid(target))
+    {
+        return { {}, inf };
+    }
 
-    for (auto bfstep = 1; bfstep < G.order(); ++bfstep)
-        for (auto edge = G.edges_begin(); edge != G.edges_end(); ++edge)
+    // Parent and distance of every reached node, from the source and from the target
+    std::unordered_map<id_type, label> forward { { source, { graph<T, V, A>::null_id, 0 } } };
+    std::unordered_map<id_type, label> backward { { target, { graph<T, V, A>::null_id, 0 } } };
+    std::vector<id_type> forward_frontier { source };
+    std::vector<id_type> backward_frontier { target };
+    std::vector<id_type> next;
+
+    weight_type best = source == target ? 0 : inf;
+    id_type meet = source == target ? source : graph<T, V, A>::null_id;
+
+    while (meet == graph<T, V, A>::null_id && !forward_frontier.empty() && !backward_frontier.empty())
+    {
+        bool forward_step = forward_frontier.size() <= backward_frontier.size();
+
+        std::vector<id_type>& frontier = forward_step ? forward_frontier : backward_frontier;
+        std::unordered_map<id_type, label>& mine = forward_step ? forward : backward;
+        std::unordered_map<id_type, label>& theirs = forward_step ? backward : forward;
+
+        next.clear();
+
+        for (id_type u : frontier)
         {
-            auto u = (*edge).first;
-            auto v = (*edge).second;
+            weight_type du = mine[u].second;
 
-            if (d[u] + G.weight(u, v) < d[v])
+            for (id_type v : forward_step ? G.out(u) : G.in(u))
             {
-                d[v] = d[u] + G.weight(u, v);
-                p[v] = u;
+                if (!mine.emplace(v, label { u, du + 1 }).second)
+                {
+                    continue;
+                }
+
+                next.push_back(v);
+                auto it = theirs.find(v);
+
+                if (it != theirs.end() && du + 1 + it->second.second < best)
+                {
+                    best = du + 1 + it->second.second;
+                    meet = v;
+                }
             }
         }
 
-    return typename graph<T, V>::path {
-        std::move(p),
-        std::move(d),
-        root
+        frontier.swap(next);
+    }
+
+    typename graph<T, V, A>::path_array p;
+
+    if (meet == graph<T, V, A>::null_id)
+    {
+        return { p, inf };
+    }
+
+    for (id_type v = meet; v != graph<T, V, A>::null_id; v = forward[v].first)
+    {
+        p.push_back(v);
+    }
+
+    std::reverse(p.begin(), p.end());
+
+    for (id_type v = backward[meet].first; v != graph<T, V, A>::null_id; v = backward[v].first)
+    {
+        p.push_back(v);
+    }
+
+    return { p, best };
+}
+
+template <typename queue_type, typename T, typename V, typename A>
+inline typename graph<T, V, A>::path_result bidirectional_dijkstra(
+    const graph<T, V, A>& G, 
+    typename graph<T, V, A>::id_type source, 
+    typename graph<T, V, A>::id_type target
+)
+{
+    using id_type = typename graph<T, V, A>::id_type;
+    using weight_type = typename graph<T, V, A>::weight_type;
+    using label = std::pair<id_type, weight_type>;
+
+    const weight_type inf = std::numeric_limits<weight_type>::max();
+
+    if (!G.is_valid(source) || !G.is_valid(target))
+    {
+        return { {}, inf };
+    }
+
+    std::unordered_map<id_type, label> labels[2] = {
+        { { source, { graph<T, V, A>::null_id, 0 } } },
+        { { target, { graph<T, V, A>::null_id, 0 } } }
     };
-}
\ No newline at end of file
+    std::unordered_set<id_type> settled[2];
+    typename queue_type::template queue<weight_type, id_type> Q[2];
+
+    weight_type best = source == target ? 0 : inf;
+    id_type meet = source == target ? source : graph<T, V, A>::null_id;
+
+    Q[0].push(0, source);
+    Q[1].push(0, target);
+
+    while (!Q[0].empty() && !Q[1].empty())
+    {
+        // A shortest path can't be shorter than the sum of the two smallest tentative distances
+        if (best != inf && Q[0].top().first + Q[1].top().first >= best)
+        {
+            break;
+        }
+
+        int side = Q[0].size() <= Q[1].size() ? 0 : 1;
+        weight_type du = Q[side].top().first;
+        id_type u = Q[side].top().second;
+        Q[side].pop();
+
+        if (!settled[side].insert(u).second)
+        {
+            continue;
+        }
+
+        for (auto e : side == 0 ? G.out_edges(u) : G.in_edges(u))
+        {
+            weight_type dv = du + e.second;
+            auto it = labels[side].find(e.first);
+
+            if (it != labels[side].end() && it->second.second <= dv)
+            {
+                continue;
+            }
+
+            labels[side][e.first] = label { u, dv };
+            Q[side].push(dv, e.first);
+
+            auto other = labels[1 - side].find(e.first);
+
+            if (other != labels[1 - side].end() && dv + other->second.second < best)
+            {
+                best = dv + other->second.second;
+                meet = e.first;
+            }
+        }
+    }
+
+    typename graph<T, V, A>::path_array p;
+
+    if (meet == graph<T, V, A>::null_id)
+    {
+        return { p, inf };
+    }
+
+    for (id_type v = meet; v != graph<T, V, A>::null_id; v = labels[0][v].first)
+    {
+        p.push_back(v);
+    }
+
+    std::reverse(p.begin(), p.end());
+
+    for (id_type v = labels[1][meet].first; v != graph<T, V, A>::null_id; v = labels[1][v].first)
+    {
+        p.push_back(v);
+    }
+
+    return { p, best };
+}
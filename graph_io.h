@@ -0,0 +1,117 @@
+// MIT License
+
+// graph - http://www.github/ilariom/graph
+// Copyright (c) 2020 - Ilario Mangano
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef graph_io_h
+#define graph_io_h
+
+#include "graph.h"
+#include "csr_graph.h"
+#include "parallel.h"
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <type_traits>
+#include <unordered_map>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace estd
+{
+
+// Binary format shared by every function below. After a fixed header, it stores
+// out offsets, targets and weights, then the same for in edges, then node values
+// and a validity byte per node, in the same layout of a csr_graph. Every array
+// starts on a 64 bytes boundary, so a mapped file can be used as it is.
+// Numbers are stored in the native byte order and sizes, which load and map check.
+// Node values must be trivially copyable.
+
+// Writes G to out. Returns false if the stream fails.
+template <typename T, typename V, typename A>
+bool save(const graph<T, V, A>& G, std::ostream& out);
+
+template <typename T, typename V>
+bool save(const csr_graph<T, V>& G, std::ostream& out);
+
+template <typename T, typename A>
+bool save(const tree<T, A>& G, std::ostream& out);
+
+// Replaces the content of G with a graph read from in. Node ids, erased nodes
+// and edge order are preserved. Returns false, leaving G empty, if the data
+// doesn't come from save or has been written with different types.
+template <typename T, typename V, typename A>
+bool load(std::istream& in, graph<T, V, A>& G);
+
+template <typename T, typename A>
+bool load(std::istream& in, tree<T, A>& G);
+
+// Maps a file written by save in read only mode and makes G a view over it,
+// with no copies. Pages are shared between all the processes mapping the same
+// file and released when the last copy of G is destroyed. Offsets and targets
+// are checked once, in O(n + m). Returns false if the file can't be mapped or
+// is not valid.
+template <typename T, typename V>
+bool map_graph(const std::string& filename, csr_graph<T, V>& G);
+
+// Reads an edge list, one "node child [weight]" line per edge, into G.
+// Fields are separated by spaces, tabs or commas, and empty lines or lines
+// starting with '#' or '%' are skipped. Nodes are named by keys of type
+// key_type (integers or std::string): keys found in ids are mapped to their
+// node, while new keys get a new node, and are added to ids.
+// The input is read in chunks of chunk_size bytes, each parsed by the given
+// number of threads (0 is one per hardware thread). Edges are only inserted
+// once the whole input has been read, so the peak memory use is O(m): besides
+// G and a chunk, the loader holds a (node, child, weight) tuple per edge.
+// Returns false, without changing G, on the first malformed line.
+template <typename key_type, typename T, typename V, typename A>
+bool load_edge_list(
+    std::istream& in, 
+    graph<T, V, A>& G, 
+    std::unordered_map<key_type, typename graph<T, V, A>::id_type>& ids, 
+    unsigned threads = 0, 
+    size_t chunk_size = 1 << 24
+);
+
+// Reads "node value" lines and assigns every value to the node named by the key,
+// inserting a node for keys not in ids yet. The value is the rest of the line,
+// and T must be arithmetic or std::string.
+template <typename key_type, typename T, typename V, typename A>
+bool load_node_values(
+    std::istream& in, 
+    graph<T, V, A>& G, 
+    std::unordered_map<key_type, typename graph<T, V, A>::id_type>& ids
+);
+
+#include "graph_io.inl"
+
+} // namespace estd
+
+#endif /* graph_io_h */
@@ -0,0 +1,965 @@
+namespace io
+{
+
+struct header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t id_size;
+    uint32_t weight_size;
+    uint32_t value_size;
+    uint32_t flags;
+    uint64_t capacity;
+    uint64_t order;
+    uint64_t size;
+};
+
+constexpr uint32_t weighted = 1;
+constexpr uint32_t negative_weights = 2;
+constexpr const char magic[8] = { 'e', 's', 't', 'd', 'g', 'r', 'p', 'h' };
+constexpr uint32_t version = 1;
+constexpr uint32_t byte_order = 0x01020304;
+constexpr size_t alignment = 64;
+
+inline size_t align(size_t pos) { return (pos + alignment - 1) / alignment * alignment; }
+
+// Position of every array in the file. Sizes come from the header, so fits is
+// false if the arrays wouldn't fit in a size_t, instead of wrapping around
+struct layout
+{
+    layout(const header& h)
+    {
+        uint64_t n = h.capacity;
+        uint64_t m = h.size;
+
+        fits = n < std::numeric_limits<uint64_t>::max();
+        offsets = align(sizeof(header));
+        targets = after(offsets, n + 1, sizeof(size_t));
+        weights = after(targets, m, h.id_size);
+        roffsets = after(weights, m, h.weight_size);
+        rtargets = after(roffsets, n + 1, sizeof(size_t));
+        rweights = after(rtargets, m, h.id_size);
+        objs = after(rweights, m, h.weight_size);
+        valid = after(objs, n, h.value_size);
+        total = fits ? valid + static_cast<size_t>(n) : 0;
+        fits = fits && total >= valid;
+    }
+
+    size_t offsets;
+    size_t targets;
+    size_t weights;
+    size_t roffsets;
+    size_t rtargets;
+    size_t rweights;
+    size_t objs;
+    size_t valid;
+    size_t total;
+    bool fits;
+
+private:
+    // Start of the array following count elements of the given size from pos
+    size_t after(size_t pos, uint64_t count, size_t size)
+    {
+        const size_t max = std::numeric_limits<size_t>::max() - alignment;
+
+        if (!fits || pos > max || (size > 0 && count > (max - pos) / size))
+        {
+            fits = false;
+            return pos;
+        }
+
+        return align(pos + static_cast<size_t>(count) * size);
+    }
+};
+
+template <typename T, typename V>
+inline header make_header(size_t capacity, size_t order, size_t size, bool is_weighted, bool has_negative_weights)
+{
+    header h;
+
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, magic, sizeof(magic));
+    h.version = version;
+    h.byte_order = byte_order;
+    h.id_size = sizeof(size_t);
+    h.weight_size = sizeof(V);
+    h.value_size = sizeof(T);
+    h.flags = (is_weighted ? weighted : 0u) | (has_negative_weights ? negative_weights : 0u);
+    h.capacity = capacity;
+    h.order = order;
+    h.size = size;
+
+    return h;
+}
+
+template <typename T, typename V>
+inline bool check_header(const header& h)
+{
+    return std::memcmp(h.magic, magic, sizeof(magic)) == 0
+        && h.version == version
+        && h.byte_order == byte_order
+        && h.id_size == sizeof(size_t)
+        && h.weight_size == sizeof(V)
+        && h.value_size == sizeof(T)
+        && h.order <= h.capacity
+        && layout { h }.fits
+    ;
+}
+
+// Offsets must go from 0 to m without ever decreasing, and every target must be a node
+inline bool check_edges(const size_t* offsets, const size_t* targets, size_t n, size_t m)
+{
+    if (offsets[0] != 0 || offsets[n] != m)
+    {
+        return false;
+    }
+
+    for (size_t node = 0; node < n; ++node)
+    {
+        if (offsets[node + 1] < offsets[node])
+        {
+            return false;
+        }
+    }
+
+    for (size_t idx = 0; idx < m; ++idx)
+    {
+        if (targets[idx] >= n)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Stream wrappers that keep track of the position, to skip the padding between arrays
+class writer
+{
+public:
+    writer(std::ostream& out)
+        : out_(out)
+    { }
+
+public:
+    template <typename U>
+    void put(const U* data, size_t n)
+    {
+        out_.write(reinterpret_cast<const char*>(data), n * sizeof(U));
+        pos_ += n * sizeof(U);
+    }
+
+    void seek(size_t pos)
+    {
+        static const char zeros[alignment] = {};
+        out_.write(zeros, pos - pos_);
+        pos_ = pos;
+    }
+
+    bool good() const { return out_.good(); }
+
+private:
+    std::ostream& out_;
+    size_t pos_ = 0;
+};
+
+class reader
+{
+public:
+    reader(std::istream& in)
+        : in_(in)
+    { }
+
+public:
+    template <typename U>
+    bool get(U* data, size_t n)
+    {
+        in_.read(reinterpret_cast<char*>(data), n * sizeof(U));
+        pos_ += n * sizeof(U);
+        return in_.good();
+    }
+
+    // Reads n elements into v, growing it a block at a time: n comes from the file, so
+    // v only gets as large as the data that's actually there before a read fails
+    template <typename container_type>
+    bool get_all(container_type& v, size_t n)
+    {
+        const size_t block = size_t { 1 } << 16;
+        bool ok = true;
+
+        v.clear();
+
+        for (size_t first = 0; ok && first < n; first += block)
+        {
+            size_t count = std::min(block, n - first);
+            v.resize(first + count);
+            ok = get(v.data() + first, count);
+        }
+
+        return ok;
+    }
+
+    bool seek(size_t pos)
+    {
+        in_.ignore(pos - pos_);
+        pos_ = pos;
+        return in_.good();
+    }
+
+private:
+    std::istream& in_;
+    size_t pos_ = 0;
+};
+
+// Works for any graph type exposing the read interface shared by graph and csr_graph
+template <typename graph_type>
+inline bool write(const graph_type& G, std::ostream& out)
+{
+    using value_type = typename graph_type::value_type;
+    using weight_type = typename graph_type::weight_type;
+    using id_type = typename graph_type::id_type;
+
+    static_assert(std::is_trivially_copyable<value_type>::value, "Only graphs of trivially copyable values can be saved");
+
+    size_t n = G.capacity();
+    header h = make_header<value_type, weight_type>(n, G.order(), G.size(), G.is_weighted(), G.has_negative_weights());
+    layout L { h };
+    writer w { out };
+
+    auto put_edges = [&] (bool reversed, size_t offsets, size_t targets, size_t weights) {
+        size_t offset = 0;
+
+        w.seek(offsets);
+        w.put(&offset, 1);
+
+        for (id_type node = 0; node < n; ++node)
+        {
+            offset += (reversed ? G.in_edges(node) : G.out_edges(node)).size();
+            w.put(&offset, 1);
+        }
+
+        w.seek(targets);
+
+        for (id_type node = 0; node < n; ++node)
+        {
+            auto edges = reversed ? G.in_edges(node) : G.out_edges(node);
+            w.put(edges.targets(), edges.size());
+        }
+
+        w.seek(weights);
+
+        for (id_type node = 0; node < n; ++node)
+        {
+            auto edges = reversed ? G.in_edges(node) : G.out_edges(node);
+
+            if (edges.weights() != nullptr)
+            {
+                w.put(edges.weights(), edges.size());
+                continue;
+            }
+
+            // Unweighted graphs are saved with unit weights, to be loaded as any other
+            for (size_t idx = 0; idx < edges.size(); ++idx)
+            {
+                weight_type one = 1;
+                w.put(&one, 1);
+            }
+        }
+    };
+
+    w.put(&h, 1);
+    put_edges(false, L.offsets, L.targets, L.weights);
+    put_edges(true, L.roffsets, L.rtargets, L.rweights);
+    w.seek(L.objs);
+
+    for (id_type node = 0; node < n; ++node)
+    {
+        value_type val = G.is_valid(node) ? G[node] : value_type {};
+        w.put(&val, 1);
+    }
+
+    w.seek(L.valid);
+
+    for (id_type node = 0; node < n; ++node)
+    {
+        unsigned char valid = G.is_valid(node) ? 1 : 0;
+        w.put(&valid, 1);
+    }
+
+    return w.good();
+}
+
+using token = std::pair<const char*, const char*>;
+
+inline bool is_separator(char c) { return c == ' ' || c == '\t' || c == ',' || c == '\r'; }
+
+// Moves first past the next field of the line and returns it, or an empty token at the end of the line
+inline token next_token(const char*& first, const char* last)
+{
+    while (first != last && is_separator(*first))
+    {
+        ++first;
+    }
+
+    const char* begin = first;
+
+    while (first != last && !is_separator(*first))
+    {
+        ++first;
+    }
+
+    return { begin, first };
+}
+
+inline bool empty(const token& t) { return t.first == t.second; }
+
+template <typename U>
+inline typename std::enable_if<std::is_integral<U>::value, bool>::type parse(const token& t, U& out)
+{
+    const char* cur = t.first;
+    bool negative = cur != t.second && *cur == '-';
+
+    if (cur != t.second && (*cur == '-' || *cur == '+'))
+    {
+        ++cur;
+    }
+
+    if (cur == t.second || (negative && !std::is_signed<U>::value))
+    {
+        return false;
+    }
+
+    // The magnitude is accumulated unsigned, up to max, or to -min for negative numbers
+    using magnitude_type = typename std::make_unsigned<U>::type;
+
+    const magnitude_type limit = negative ?
+        static_cast<magnitude_type>(static_cast<magnitude_type>(std::numeric_limits<U>::max()) + 1)
+        : static_cast<magnitude_type>(std::numeric_limits<U>::max())
+    ;
+
+    magnitude_type m = 0;
+
+    for (; cur != t.second; ++cur)
+    {
+        if (*cur < '0' || *cur > '9')
+        {
+            return false;
+        }
+
+        magnitude_type digit = static_cast<magnitude_type>(*cur - '0');
+
+        if (m > (limit - digit) / 10)
+        {
+            return false;
+        }
+
+        m = static_cast<magnitude_type>(m * 10 + digit);
+    }
+
+    out = negative ? static_cast<U>(0 - m) : static_cast<U>(m);
+    return true;
+}
+
+template <typename U>
+inline typename std::enable_if<std::is_floating_point<U>::value, bool>::type parse(const token& t, U& out)
+{
+    // Tokens aren't null terminated, and are short enough to be copied on the stack
+    char s[64];
+    size_t n = t.second - t.first;
+
+    if (n == 0 || n >= sizeof(s))
+    {
+        return false;
+    }
+
+    std::memcpy(s, t.first, n);
+    s[n] = 0;
+
+    char* end = nullptr;
+    out = static_cast<U>(std::strtod(s, &end));
+
+    return end == s + n;
+}
+
+inline bool parse(const token& t, std::string& out)
+{
+    out.assign(t.first, t.second);
+    return true;
+}
+
+// Keys are parsed in parallel when they are numbers, while string keys are
+// only located there, and copied when they are looked up
+template <typename key_type>
+struct key_traits
+{
+    using parsed_type = key_type;
+
+    static bool parse(const token& t, parsed_type& out) { return io::parse(t, out); }
+    static const key_type& key(const parsed_type& k, key_type&) { return k; }
+};
+
+template <>
+struct key_traits<std::string>
+{
+    using parsed_type = token;
+
+    static bool parse(const token& t, parsed_type& out) { out = t; return true; }
+    static const std::string& key(const parsed_type& k, std::string& scratch) { scratch.assign(k.first, k.second); return scratch; }
+};
+
+// Calls fn(first, last) on consecutive blocks of whole lines read from in
+template <typename function_type>
+inline void for_each_chunk(std::istream& in, size_t chunk_size, function_type fn)
+{
+    std::vector<char> buffer;
+    size_t carry = 0;
+
+    chunk_size = std::max<size_t>(chunk_size, 1);
+
+    while (in)
+    {
+        buffer.resize(carry + chunk_size);
+        in.read(buffer.data() + carry, chunk_size);
+
+        size_t filled = carry + static_cast<size_t>(in.gcount());
+        size_t end = filled;
+
+        if (in)
+        {
+            while (end > 0 && buffer[end - 1] != '\n')
+            {
+                --end;
+            }
+
+            // A single line longer than the chunk: keep reading until it's complete
+            if (end == 0)
+            {
+                carry = filled;
+                continue;
+            }
+        }
+
+        fn(buffer.data(), buffer.data() + end);
+
+        carry = filled - end;
+        std::copy(buffer.begin() + end, buffer.begin() + filled, buffer.begin());
+    }
+}
+
+inline bool is_comment(const char* first, const char* last)
+{
+    token t = next_token(first, last);
+    return empty(t) || *t.first == '#' || *t.first == '%';
+}
+
+} // namespace io
+
+template <typename T, typename V, typename A>
+inline bool save(const graph<T, V, A>& G, std::ostream& out)
+{
+    return io::write(G, out);
+}
+
+template <typename T, typename V>
+inline bool save(const csr_graph<T, V>& G, std::ostream& out)
+{
+    return io::write(G, out);
+}
+
+template <typename T, typename A>
+inline bool save(const tree<T, A>& G, std::ostream& out)
+{
+    // Trees are saved as the graph of their (parent, child) edges, with the same ids
+    graph<T> copy;
+    std::vector<typename graph<T>::id_type> erased;
+
+    copy.insert(G.objs_.begin(), G.objs_.end());
+
+    for (typename tree<T, A>::id_type node = 0; node < G.capacity(); ++node)
+    {
+        if (!G.is_valid(node))
+        {
+            erased.push_back(node);
+            continue;
+        }
+
+        for (auto child : G.children(node))
+        {
+            copy.edge(node, child);
+        }
+    }
+
+    copy.erase(erased);
+
+    return io::write(copy, out);
+}
+
+template <typename T, typename V, typename A>
+inline bool load(std::istream& in, graph<T, V, A>& G)
+{
+    using id_type = typename graph<T, V, A>::id_type;
+    using weight_type = typename graph<T, V, A>::weight_type;
+
+    static_assert(std::is_trivially_copyable<T>::value, "Only graphs of trivially copyable values can be loaded");
+
+    io::header h;
+    io::reader r { in };
+
+    auto clear = [&G] () {
+        G.adjs_.clear();
+        G.radjs_.clear();
+        G.ws_.clear();
+        G.rws_.clear();
+        G.objs_.clear();
+        G.live_.clear();
+        G.free_.clear();
+        G.edges_ = 0;
+        G.weighted_ = false;
+        G.negative_weights_ = false;
+        G.version_++;
+    };
+
+    clear();
+
+    if (!r.get(&h, 1) || !io::check_header<T, weight_type>(h))
+    {
+        return false;
+    }
+
+    // Weights other than 1 would be lost by an unweighted graph, which reads none of them
+    if (!weight_storage<V, A>::stored && (h.flags & io::weighted) != 0)
+    {
+        return false;
+    }
+
+    io::layout L { h };
+    size_t n = h.capacity;
+    std::vector<size_t> offsets;
+
+    using nodes_container = typename graph<T, V, A>::nodes_container;
+    using weights_container = typename graph<T, V, A>::weights_container;
+
+    auto get_edges = [&] (
+        typename graph<T, V, A>::adjacency_container& adjs,
+        decltype(G.ws_)& ws,
+        size_t first, size_t targets, size_t weights
+    ) {
+        if (!r.seek(first) || !r.get_all(offsets, n + 1) || offsets[0] != 0 || offsets[n] != h.size)
+        {
+            return false;
+        }
+
+        adjs.resize(n, nodes_container(G.get_allocator()));
+        ws.resize(n, weights_container(G.get_allocator()));
+
+        bool ok = r.seek(targets);
+
+        for (id_type node = 0; ok && node < n; ++node)
+        {
+            if (offsets[node + 1] < offsets[node])
+            {
+                return false;
+            }
+
+            ok = r.get_all(adjs[node], offsets[node + 1] - offsets[node]);
+
+            for (id_type other : adjs[node])
+            {
+                ok = ok && other < n;
+            }
+        }
+
+        ok = ok && r.seek(weights);
+
+        for (id_type node = 0; ok && node < n; ++node)
+        {
+            ws[node].resize(adjs[node].size());
+            ok = r.get(ws[node].data(), ws[node].size());
+        }
+
+        return ok;
+    };
+
+    std::vector<unsigned char> valid;
+
+    bool ok = get_edges(G.adjs_, G.ws_, L.offsets, L.targets, L.weights)
+        && get_edges(G.radjs_, G.rws_, L.roffsets, L.rtargets, L.rweights)
+        && r.seek(L.objs) && r.get_all(G.objs_, n)
+        && r.seek(L.valid) && r.get_all(valid, n)
+    ;
+
+    if (!ok)
+    {
+        clear();
+        return false;
+    }
+
+    G.live_.assign((n + 63) / 64, 0);
+
+    for (id_type node = 0; node < n; ++node)
+    {
+        if (valid[node])
+        {
+            G.set_live(node, true);
+        }
+        else
+        {
+            G.free_.push_back(node);
+        }
+    }
+
+    G.edges_ = h.size;
+    G.weighted_ = (h.flags & io::weighted) != 0;
+    G.negative_weights_ = (h.flags & io::negative_weights) != 0;
+
+    return true;
+}
+
+template <typename T, typename A>
+inline bool load(std::istream& in, tree<T, A>& G)
+{
+    using id_type = typename tree<T, A>::id_type;
+
+    graph<T> copy;
+    G = tree<T, A> { G.get_allocator() };
+
+    if (!load(in, copy))
+    {
+        return false;
+    }
+
+    size_t reached = 0;
+    std::vector<id_type> next;
+
+    // Every node needs at most one parent, and all of them must be reached from the roots
+    for (id_type node = 0; node < copy.capacity(); ++node)
+    {
+        if (copy.in(node).size() > 1)
+        {
+            return false;
+        }
+
+        if (copy.is_valid(node) && copy.in(node).empty())
+        {
+            next.push_back(node);
+        }
+    }
+
+    while (!next.empty())
+    {
+        id_type node = next.back();
+        next.pop_back();
+        reached++;
+        next.insert(next.end(), copy.out(node).begin(), copy.out(node).end());
+    }
+
+    if (reached != copy.order())
+    {
+        return false;
+    }
+
+    std::vector<id_type> erased;
+    std::vector<T> values;
+
+    for (id_type node = 0; node < copy.capacity(); ++node)
+    {
+        values.push_back(copy[node]);
+    }
+
+    G.insert(values.begin(), values.end());
+
+    for (id_type node = 0; node < copy.capacity(); ++node)
+    {
+        if (!copy.is_valid(node))
+        {
+            erased.push_back(node);
+        }
+
+        for (id_type child : copy.out(node))
+        {
+            G.append(node, child);
+        }
+    }
+
+    G.erase(erased);
+
+    return true;
+}
+
+template <typename T, typename V>
+inline bool map_graph(const std::string& filename, csr_graph<T, V>& G)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Only graphs of trivially copyable values can be mapped");
+
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = ::open(filename.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(io::header))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    size_t length = st.st_size;
+    void* addr = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (addr == MAP_FAILED)
+    {
+        return false;
+    }
+
+    std::shared_ptr<const void> mapping { addr, [length] (const void* p) { ::munmap(const_cast<void*>(p), length); } };
+    const char* base = static_cast<const char*>(addr);
+    const io::header& h = *reinterpret_cast<const io::header*>(base);
+
+    if (!io::check_header<T, V>(h) || io::layout { h }.total > length)
+    {
+        return false;
+    }
+
+    io::layout L { h };
+    const size_t* offsets = reinterpret_cast<const size_t*>(base + L.offsets);
+    const size_t* roffsets = reinterpret_cast<const size_t*>(base + L.roffsets);
+    const size_t* targets = reinterpret_cast<const size_t*>(base + L.targets);
+    const size_t* rtargets = reinterpret_cast<const size_t*>(base + L.rtargets);
+
+    // Visits trust the arrays they read ids from, so these are checked once here
+    if (!io::check_edges(offsets, targets, h.capacity, h.size) || !io::check_edges(roffsets, rtargets, h.capacity, h.size))
+    {
+        return false;
+    }
+
+    G.offsets_ = offsets;
+    G.roffsets_ = roffsets;
+    G.targets_ = targets;
+    G.rtargets_ = rtargets;
+    G.weights_ = reinterpret_cast<const V*>(base + L.weights);
+    G.rweights_ = reinterpret_cast<const V*>(base + L.rweights);
+    G.objs_ = reinterpret_cast<const T*>(base + L.objs);
+    G.valid_ = reinterpret_cast<const unsigned char*>(base + L.valid);
+    G.capacity_ = h.capacity;
+    G.size_ = h.size;
+    G.order_ = h.order;
+    G.weighted_ = (h.flags & io::weighted) != 0;
+    G.negative_weights_ = (h.flags & io::negative_weights) != 0;
+    G.storage_ = std::move(mapping);
+
+    return true;
+#else
+    (void)filename;
+    (void)G;
+    return false;
+#endif
+}
+
+template <typename key_type, typename T, typename V, typename A>
+inline bool load_edge_list(
+    std::istream& in, 
+    graph<T, V, A>& G, 
+    std::unordered_map<key_type, typename graph<T, V, A>::id_type>& ids, 
+    unsigned threads, 
+    size_t chunk_size
+)
+{
+    using id_type = typename graph<T, V, A>::id_type;
+    using weight_type = typename graph<T, V, A>::weight_type;
+    using parsed_type = typename io::key_traits<key_type>::parsed_type;
+
+    struct record
+    {
+        parsed_type node;
+        parsed_type child;
+        weight_type weight;
+    };
+
+    struct block
+    {
+        const char* first;
+        const char* last;
+        std::vector<record> records;
+        bool ok;
+    };
+
+    threads = execution::concurrency(threads);
+
+    std::vector<block> blocks;
+    std::vector<std::tuple<id_type, id_type, weight_type>> edges;
+    id_type start = G.capacity();
+    id_type next = start;
+    key_type scratch {};
+    bool ok = true;
+
+    auto id_of = [&] (const parsed_type& k) {
+        const key_type& key = io::key_traits<key_type>::key(k, scratch);
+        auto it = ids.find(key);
+
+        if (it != ids.end())
+        {
+            return it->second;
+        }
+
+        ids.emplace(key, next);
+
+        return next++;
+    };
+
+    auto parse_block = [] (block& b) {
+        b.records.clear();
+        b.ok = true;
+
+        for (const char* line = b.first; line != b.last; )
+        {
+            const char* eol = std::find(line, b.last, '\n');
+            const char* cur = line;
+            line = eol == b.last ? eol : eol + 1;
+
+            if (io::is_comment(cur, eol))
+            {
+                continue;
+            }
+
+            record r;
+            io::token node = io::next_token(cur, eol);
+            io::token child = io::next_token(cur, eol);
+            io::token weight = io::next_token(cur, eol);
+
+            r.weight = 1;
+
+            if (io::empty(child)
+                || !io::key_traits<key_type>::parse(node, r.node)
+                || !io::key_traits<key_type>::parse(child, r.child)
+                || (!io::empty(weight) && !io::parse(weight, r.weight)))
+            {
+                b.ok = false;
+                return;
+            }
+
+            b.records.push_back(r);
+        }
+    };
+
+    io::for_each_chunk(in, chunk_size, [&] (const char* first, const char* last) {
+        if (!ok)
+        {
+            return;
+        }
+
+        // Splits the chunk in blocks of whole lines, a few per thread to balance them
+        size_t count = threads * 4;
+        size_t step = (last - first) / count + 1;
+
+        blocks.resize(count);
+
+        for (block& b : blocks)
+        {
+            b.first = first;
+            first = std::min(last, first + step);
+            first = first == last ? last : std::find(first, last, '\n');
+            first = first == last ? last : first + 1;
+            b.last = first;
+        }
+
+        execution::parallel_for(threads, blocks.size(), 1, [&blocks, &parse_block] (size_t lo, size_t hi, unsigned) {
+            for (size_t idx = lo; idx < hi; ++idx)
+            {
+                parse_block(blocks[idx]);
+            }
+        });
+
+        for (block& b : blocks)
+        {
+            ok = ok && b.ok;
+
+            for (size_t idx = 0; ok && idx < b.records.size(); ++idx)
+            {
+                const record& r = b.records[idx];
+                id_type node = id_of(r.node);
+                id_type child = id_of(r.child);
+                edges.emplace_back(node, child, r.weight);
+            }
+        }
+    });
+
+    if (!ok)
+    {
+        for (auto it = ids.begin(); it != ids.end(); )
+        {
+            it = it->second >= start ? ids.erase(it) : std::next(it);
+        }
+
+        return false;
+    }
+
+    std::vector<T> values(next - start);
+    G.insert(values.begin(), values.end());
+    G.insert_edges(edges.begin(), edges.end());
+
+    return true;
+}
+
+template <typename key_type, typename T, typename V, typename A>
+inline bool load_node_values(
+    std::istream& in, 
+    graph<T, V, A>& G, 
+    std::unordered_map<key_type, typename graph<T, V, A>::id_type>& ids
+)
+{
+    using parsed_type = typename io::key_traits<key_type>::parsed_type;
+
+    std::string line;
+    key_type scratch {};
+
+    while (std::getline(in, line))
+    {
+        const char* cur = line.data();
+        const char* eol = cur + line.size();
+
+        if (io::is_comment(cur, eol))
+        {
+            continue;
+        }
+
+        parsed_type k;
+        io::token node = io::next_token(cur, eol);
+
+        while (cur != eol && io::is_separator(*cur))
+        {
+            ++cur;
+        }
+
+        while (eol != cur && io::is_separator(eol[-1]))
+        {
+            --eol;
+        }
+
+        T val {};
+
+        if (!io::key_traits<key_type>::parse(node, k) || !io::parse(io::token { cur, eol }, val))
+        {
+            return false;
+        }
+
+        const key_type& key = io::key_traits<key_type>::key(k, scratch);
+        auto it = ids.find(key);
+
+        if (it == ids.end())
+        {
+            it = ids.emplace(key, G.insert(val)).first;
+        }
+        else
+        {
+            G[it->second] = val;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,199 @@
+namespace heap
+{
+
+template <size_t arity>
+struct d_ary
+{
+    static_assert(arity >= 2, "A heap needs at least two children per node");
+
+    template <typename key_type, typename value_type>
+    class queue
+    {
+    public:
+        using entry_type = std::pair<key_type, value_type>;
+
+    public:
+        void push(key_type key, value_type value);
+        void pop();
+        const entry_type& top() const { return entries_.front(); }
+        bool empty() const { return entries_.empty(); }
+        size_t size() const { return entries_.size(); }
+        void clear() { entries_.clear(); }
+        void reserve(size_t n) { entries_.reserve(n); }
+
+    private:
+        std::vector<entry_type> entries_;
+    };
+};
+
+using binary = d_ary<2>;
+
+// Monotone integer priority queue: keys pushed must never be smaller than
+// the last popped one, which is always the case for Dijkstra on non-negative weights.
+struct radix
+{
+    template <typename key_type, typename value_type>
+    class queue
+    {
+        static_assert(std::is_integral<key_type>::value, "Radix heap requires integral keys");
+
+    public:
+        using entry_type = std::pair<key_type, value_type>;
+        using ukey_type = typename std::make_unsigned<key_type>::type;
+
+    public:
+        void push(key_type key, value_type value);
+        void pop();
+        const entry_type& top() const;
+        bool empty() const { return size_ == 0; }
+        size_t size() const { return size_; }
+        void clear();
+        void reserve(size_t) { }
+
+    private:
+        void pull() const;
+
+        static size_t bucket_of(ukey_type key, ukey_type last)
+        {
+            size_t b = 0;
+
+            for (ukey_type x = key ^ last; x != 0; x >>= 1)
+            {
+                ++b;
+            }
+
+            return b;
+        }
+
+    private:
+        mutable std::vector<entry_type> buckets_[std::numeric_limits<ukey_type>::digits + 1];
+        mutable ukey_type last_ = 0;
+        size_t size_ = 0;
+    };
+};
+
+template <typename key_type>
+using preferred = typename std::conditional<std::is_integral<key_type>::value, radix, binary>::type;
+
+template <size_t arity>
+template <typename key_type, typename value_type>
+inline void d_ary<arity>::queue<key_type, value_type>::push(key_type key, value_type value)
+{
+    size_t idx = entries_.size();
+    entries_.emplace_back(key, value);
+
+    while (idx > 0)
+    {
+        size_t parent = (idx - 1) / arity;
+
+        if (!(entries_[idx].first < entries_[parent].first))
+        {
+            break;
+        }
+
+        std::swap(entries_[idx], entries_[parent]);
+        idx = parent;
+    }
+}
+
+template <size_t arity>
+template <typename key_type, typename value_type>
+inline void d_ary<arity>::queue<key_type, value_type>::pop()
+{
+    entries_.front() = entries_.back();
+    entries_.pop_back();
+
+    size_t idx = 0;
+    size_t n = entries_.size();
+
+    while (true)
+    {
+        size_t first = idx * arity + 1;
+
+        if (first >= n)
+        {
+            break;
+        }
+
+        size_t last = std::min(first + arity, n);
+        size_t best = first;
+
+        for (size_t child = first + 1; child < last; ++child)
+        {
+            if (entries_[child].first < entries_[best].first)
+            {
+                best = child;
+            }
+        }
+
+        if (!(entries_[best].first < entries_[idx].first))
+        {
+            break;
+        }
+
+        std::swap(entries_[idx], entries_[best]);
+        idx = best;
+    }
+}
+
+template <typename key_type, typename value_type>
+inline void radix::queue<key_type, value_type>::push(key_type key, value_type value)
+{
+    buckets_[bucket_of(static_cast<ukey_type>(key), last_)].emplace_back(key, value);
+    size_++;
+}
+
+template <typename key_type, typename value_type>
+inline void radix::queue<key_type, value_type>::pull() const
+{
+    if (!buckets_[0].empty())
+    {
+        return;
+    }
+
+    size_t b = 1;
+
+    while (buckets_[b].empty())
+    {
+        ++b;
+    }
+
+    auto& bucket = buckets_[b];
+    last_ = static_cast<ukey_type>(std::min_element(bucket.begin(), bucket.end())->first);
+
+    for (auto& entry : bucket)
+    {
+        buckets_[bucket_of(static_cast<ukey_type>(entry.first), last_)].push_back(entry);
+    }
+
+    bucket.clear();
+}
+
+template <typename key_type, typename value_type>
+inline const typename radix::queue<key_type, value_type>::entry_type& radix::queue<key_type, value_type>::top() const
+{
+    pull();
+    return buckets_[0].back();
+}
+
+template <typename key_type, typename value_type>
+inline void radix::queue<key_type, value_type>::pop()
+{
+    pull();
+    buckets_[0].pop_back();
+    size_--;
+}
+
+template <typename key_type, typename value_type>
+inline void radix::queue<key_type, value_type>::clear()
+{
+    for (auto& bucket : buckets_)
+    {
+        bucket.clear();
+    }
+
+    last_ = 0;
+    size_ = 0;
+}
+
+} // namespace heap
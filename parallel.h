@@ -0,0 +1,235 @@
+// MIT License
+
+// graph - http://www.github/ilariom/graph
+// Copyright (c) 2020 - Ilario Mangano
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef parallel_h
+#define parallel_h
+
+#include "graph.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <tuple>
+
+namespace estd
+{
+
+namespace execution
+{
+
+// Number of threads to use when 0 is asked: one per hardware thread.
+inline unsigned concurrency(unsigned threads)
+{
+    if (threads > 0)
+    {
+        return threads;
+    }
+
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw > 0 ? hw : 1;
+}
+
+// Runs fn(first, last, thread_idx) over chunks of [0, n) on the given number of threads.
+// Chunks are handed out dynamically, so skewed workloads stay balanced.
+template <typename function_type>
+void parallel_for(unsigned threads, size_t n, size_t grain, function_type fn);
+
+// Threads started once and reused by many parallel_for calls, for algorithms that run
+// one parallel step after the other. The calling thread takes part in every step and
+// the others wait on a condition variable in between, so no thread is created per step.
+class thread_pool
+{
+public:
+    explicit thread_pool(unsigned threads = 0);
+    ~thread_pool();
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+public:
+    // Same as execution::parallel_for, returns when every chunk is done.
+    // Not to be called by more than one thread at a time
+    template <typename function_type>
+    void parallel_for(size_t n, size_t grain, function_type fn);
+
+    unsigned size() const { return threads_; }
+
+private:
+    template <typename function_type>
+    static void invoke(void* fn, size_t first, size_t last, unsigned idx) { (*static_cast<function_type*>(fn))(first, last, idx); }
+
+    void run(unsigned idx);
+    void work(unsigned idx);
+
+private:
+    unsigned threads_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    void (*task_)(void*, size_t, size_t, unsigned) = nullptr;
+    void* fn_ = nullptr;
+    std::atomic<size_t> next_ { 0 };
+    size_t n_ = 0;
+    size_t grain_ = 1;
+    size_t step_ = 0;
+    unsigned busy_ = 0;
+    bool stop_ = false;
+};
+
+template <typename T, typename V, typename A, typename policy_type>
+struct bound_graph
+{
+    const graph<T, V, A>& G;
+    policy_type policy;
+};
+
+template <typename iterator_type, typename T, typename V, typename A, typename policy_type>
+typename graph<T, V, A>::path operator>(const iterator_type& it, const bound_graph<T, V, A, policy_type>& G);
+
+struct sequenced_policy
+{ };
+
+struct parallel_policy
+{
+    constexpr parallel_policy(unsigned threads_count = 0, double bucket_width = 0)
+        : threads(threads_count), delta(bucket_width)
+    { }
+
+    // Binds the policy to a graph, so that search_iterator > policy(G) runs in parallel.
+    template <typename T, typename V, typename A>
+    bound_graph<T, V, A, parallel_policy> operator()(const graph<T, V, A>& G) const { return { G, *this }; }
+
+    unsigned threads;
+    double delta;
+};
+
+constexpr sequenced_policy seq {};
+constexpr parallel_policy par {};
+
+// Small number that tells apart the threads of the process, handed out in order of first call.
+unsigned thread_index();
+
+// Per-thread state kept in a vector, with the padding that keeps each element's hot fields
+// off the cache line of its neighbours, so that threads don't slow each other down writing them.
+// It's padded rather than aligned, as vectors don't honour over-aligned types before C++17.
+template <typename T>
+struct cache_padded : T
+{
+    char padding[64];
+};
+
+} // namespace execution
+
+// Collects edges from many threads at once, then adds them to a graph in a single parallel pass.
+// Every thread appends to a shard of its own (picked by execution::thread_index()), so add_edge
+// takes no global lock: each shard has a flag that only threads sharing the shard contend for.
+// Edges added by the same thread keep their relative order in the adjacency lists.
+template <typename T, typename V = ssize_t, typename A = std::allocator<T>>
+class graph_builder
+{
+public:
+    using id_type = typename graph<T, V, A>::id_type;
+    using weight_type = typename graph<T, V, A>::weight_type;
+    using size_type = typename graph<T, V, A>::size_type;
+
+public:
+    // Shards default to twice the hardware threads
+    explicit graph_builder(unsigned shards = 0);
+
+    graph_builder(const graph_builder&) = delete;
+    graph_builder& operator=(const graph_builder&) = delete;
+
+public:
+    // Safe to call from any number of threads at the same time
+    void add_edge(id_type node, id_type child, weight_type w = 1);
+
+    // Room for about this many edges in total, spread over the shards
+    void reserve(size_type edges);
+
+    // Adds every collected edge to G and empties the builder. Both ends of every
+    // edge must already be nodes of G, and no add_edge can run in the meantime
+    void build(graph<T, V, A>& G, unsigned threads = 0) { merge(G, false, threads); }
+    void build(undirected_graph<T, V, A>& G, unsigned threads = 0) { merge(G, true, threads); }
+
+    // Edges collected so far, not to be called while edges are being added
+    size_type size() const;
+
+private:
+    struct record
+    {
+        id_type node;
+        id_type child;
+        weight_type w;
+    };
+
+    struct shard
+    {
+        std::atomic<bool> busy { false };
+        std::vector<record> edges;
+    };
+
+private:
+    void merge(graph<T, V, A>& G, bool symmetric, unsigned threads);
+
+private:
+    std::vector<execution::cache_padded<shard>> shards_;
+};
+
+// Level synchronous BFS that switches between top-down steps over out()
+// and bottom-up steps over in(), depending on the size of the frontier.
+template <typename T, typename V, typename A>
+typename graph<T, V, A>::path parallel_bfs_distance(const graph<T, V, A>& G, typename graph<T, V, A>::id_type root, unsigned threads = 0);
+
+// Parallel single source shortest paths for non-negative weights.
+// Nodes are kept in buckets of width delta and each bucket is settled by
+// relaxing light edges (weight <= delta) in rounds, then heavy edges once.
+// A delta of 0 picks the average edge weight. At most n + 2 buckets are kept,
+// so memory doesn't depend on how much heavier than delta the edges are.
+template <typename T, typename V, typename A>
+typename graph<T, V, A>::path delta_stepping(
+    const graph<T, V, A>& G, 
+    typename graph<T, V, A>::id_type root, 
+    typename graph<T, V, A>::weight_type delta = 0, 
+    unsigned threads = 0
+);
+
+template <typename T, typename V, typename A>
+typename graph<T, V, A>::path bfs_distance(const graph<T, V, A>& G, typename graph<T, V, A>::id_type root, execution::sequenced_policy);
+
+template <typename T, typename V, typename A>
+typename graph<T, V, A>::path bfs_distance(const graph<T, V, A>& G, typename graph<T, V, A>::id_type root, const execution::parallel_policy& policy);
+
+template <typename T, typename V, typename A>
+typename graph<T, V, A>::path bellman_ford(const graph<T, V, A>& G, typename graph<T, V, A>::id_type root, execution::sequenced_policy);
+
+// Runs delta_stepping, unless the graph has negative weights.
+template <typename T, typename V, typename A>
+typename graph<T, V, A>::path bellman_ford(const graph<T, V, A>& G, typename graph<T, V, A>::id_type root, const execution::parallel_policy& policy);
+
+#include "parallel.inl"
+
+} // namespace estd
+
+#endif /* parallel_h */
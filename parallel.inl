@@ -0,0 +1,771 @@
+namespace execution
+{
+
+template <typename function_type>
+inline void parallel_for(unsigned threads, size_t n, size_t grain, function_type fn)
+{
+    threads = concurrency(threads);
+    grain = std::max<size_t>(grain, 1);
+
+    if (threads == 1 || n <= grain)
+    {
+        fn(size_t { 0 }, n, 0u);
+        return;
+    }
+
+    std::atomic<size_t> next { 0 };
+
+    auto worker = [&next, &fn, n, grain] (unsigned idx) {
+        for (size_t first = next.fetch_add(grain); first < n; first = next.fetch_add(grain))
+        {
+            fn(first, std::min(first + grain, n), idx);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+
+    for (unsigned idx = 1; idx < threads; ++idx)
+    {
+        pool.emplace_back(worker, idx);
+    }
+
+    worker(0);
+
+    for (auto& t : pool)
+    {
+        t.join();
+    }
+}
+
+inline thread_pool::thread_pool(unsigned threads)
+    : threads_(concurrency(threads))
+{
+    workers_.reserve(threads_ - 1);
+
+    for (unsigned idx = 1; idx < threads_; ++idx)
+    {
+        workers_.emplace_back(&thread_pool::run, this, idx);
+    }
+}
+
+inline thread_pool::~thread_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock { mutex_ };
+        stop_ = true;
+    }
+
+    wake_.notify_all();
+
+    for (auto& t : workers_)
+    {
+        t.join();
+    }
+}
+
+template <typename function_type>
+inline void thread_pool::parallel_for(size_t n, size_t grain, function_type fn)
+{
+    grain = std::max<size_t>(grain, 1);
+
+    if (threads_ == 1 || n <= grain)
+    {
+        fn(size_t { 0 }, n, 0u);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock { mutex_ };
+        task_ = &thread_pool::invoke<function_type>;
+        fn_ = &fn;
+        n_ = n;
+        grain_ = grain;
+        next_.store(0, std::memory_order_relaxed);
+        busy_ = threads_ - 1;
+        step_++;
+    }
+
+    wake_.notify_all();
+    work(0);
+
+    std::unique_lock<std::mutex> lock { mutex_ };
+    done_.wait(lock, [this] { return busy_ == 0; });
+}
+
+inline void thread_pool::run(unsigned idx)
+{
+    size_t seen = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock { mutex_ };
+            wake_.wait(lock, [this, seen] { return stop_ || step_ != seen; });
+
+            if (stop_)
+            {
+                return;
+            }
+
+            seen = step_;
+        }
+
+        work(idx);
+
+        std::lock_guard<std::mutex> lock { mutex_ };
+
+        if (--busy_ == 0)
+        {
+            done_.notify_one();
+        }
+    }
+}
+
+inline void thread_pool::work(unsigned idx)
+{
+    for (size_t first = next_.fetch_add(grain_); first < n_; first = next_.fetch_add(grain_))
+    {
+        task_(fn_, first, std::min(first + grain_, n_), idx);
+    }
+}
+
+inline unsigned thread_index()
+{
+    static std::atomic<unsigned> next { 0 };
+    thread_local unsigned idx = next.fetch_add(1, std::memory_order_relaxed);
+
+    return idx;
+}
+
+} // namespace execution
+
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::path parallel_bfs_distance(const graph<T, V, A>& G, typename graph<T, V, A>::id_type root, unsigned threads)
+{
+    using id_type = typename graph<T, V, A>::id_type;
+    using weight_type = typename graph<T, V, A>::weight_type;
+
+    // Thresholds to switch to bottom-up and back, as in Beamer et al.
+    const size_t alpha = 14;
+    const size_t beta = 24;
+    const size_t grain = 256;
+    const id_type null_id = graph<T, V, A>::null_id;
+
+    struct thread_state
+    {
+        std::vector<id_type> next;
+        size_t visited = 0;
+        size_t out_edges = 0;
+        size_t in_edges = 0;
+    };
+
+    threads = execution::concurrency(threads);
+    size_t n = G.capacity();
+
+    std::vector<std::atomic<id_type>> parent(n);
+    std::vector<weight_type> level(n, std::numeric_limits<weight_type>::max());
+    std::vector<execution::cache_padded<thread_state>> states(threads);
+    execution::thread_pool pool { threads };
+
+    pool.parallel_for(n, 4096, [&parent, null_id] (size_t first, size_t last, unsigned) {
+        for (size_t v = first; v < last; ++v)
+        {
+            parent[v].store(null_id, std::memory_order_relaxed);
+        }
+    });
+
+    std::vector<id_type> frontier { root };
+    std::vector<unsigned char> in_frontier;
+    std::vector<unsigned char> in_next;
+
+    parent[root].store(root, std::memory_order_relaxed);
+    level[root] = 0;
+
+    size_t frontier_size = 1;
+    size_t frontier_edges = G.out(root).size();
+    size_t unexplored_edges = G.size() - G.in(root).size();
+    bool bottom_up = false;
+    weight_type depth = 0;
+
+    auto collect = [&states] () {
+        size_t visited = 0;
+        size_t out_edges = 0;
+        size_t in_edges = 0;
+
+        for (thread_state& state : states)
+        {
+            visited += state.visited;
+            out_edges += state.out_edges;
+            in_edges += state.in_edges;
+            state.visited = state.out_edges = state.in_edges = 0;
+        }
+
+        return std::make_tuple(visited, out_edges, in_edges);
+    };
+
+    while (frontier_size > 0)
+    {
+        if (!bottom_up && frontier_edges > unexplored_edges / alpha)
+        {
+            in_frontier.assign(n, 0);
+            in_next.assign(n, 0);
+
+            for (id_type node : frontier)
+            {
+                in_frontier[node] = 1;
+            }
+
+            bottom_up = true;
+        }
+        else if (bottom_up && frontier_size < n / beta)
+        {
+            pool.parallel_for(n, 4096, [&states, &in_frontier] (size_t first, size_t last, unsigned idx) {
+                for (size_t v = first; v < last; ++v)
+                {
+                    if (in_frontier[v])
+                    {
+                        states[idx].next.push_back(v);
+                    }
+                }
+            });
+
+            frontier.clear();
+
+            for (thread_state& state : states)
+            {
+                frontier.insert(frontier.end(), state.next.begin(), state.next.end());
+                state.next.clear();
+            }
+
+            bottom_up = false;
+        }
+
+        if (bottom_up)
+        {
+            pool.parallel_for(n, grain, [&] (size_t first, size_t last, unsigned idx) {
+                thread_state& state = states[idx];
+
+                for (size_t v = first; v < last; ++v)
+                {
+                    in_next[v] = 0;
+
+                    if (parent[v].load(std::memory_order_relaxed) != null_id)
+                    {
+                        continue;
+                    }
+
+                    for (id_type u : G.in(v))
+                    {
+                        if (in_frontier[u])
+                        {
+                            parent[v].store(u, std::memory_order_relaxed);
+                            level[v] = depth + 1;
+                            in_next[v] = 1;
+                            state.visited++;
+                            state.out_edges += G.out(v).size();
+                            state.in_edges += G.in(v).size();
+                            break;
+                        }
+                    }
+                }
+            });
+
+            in_frontier.swap(in_next);
+        }
+        else
+        {
+            pool.parallel_for(frontier.size(), grain, [&] (size_t first, size_t last, unsigned idx) {
+                thread_state& state = states[idx];
+
+                for (size_t k = first; k < last; ++k)
+                {
+                    id_type u = frontier[k];
+
+                    for (id_type v : G.out(u))
+                    {
+                        id_type expected = null_id;
+
+                        if (parent[v].load(std::memory_order_relaxed) != null_id
+                            || !parent[v].compare_exchange_strong(expected, u, std::memory_order_relaxed))
+                        {
+                            continue;
+                        }
+
+                        level[v] = depth + 1;
+                        state.next.push_back(v);
+                        state.visited++;
+                        state.out_edges += G.out(v).size();
+                        state.in_edges += G.in(v).size();
+                    }
+                }
+            });
+
+            frontier.clear();
+
+            for (thread_state& state : states)
+            {
+                frontier.insert(frontier.end(), state.next.begin(), state.next.end());
+                state.next.clear();
+            }
+        }
+
+        size_t in_edges = 0;
+        std::tie(frontier_size, frontier_edges, in_edges) = collect();
+        unexplored_edges -= std::min(unexplored_edges, in_edges);
+        depth++;
+    }
+
+    std::vector<id_type> p(n);
+
+    pool.parallel_for(n, 4096, [&parent, &p] (size_t first, size_t last, unsigned) {
+        for (size_t v = first; v < last; ++v)
+        {
+            p[v] = parent[v].load(std::memory_order_relaxed);
+        }
+    });
+
+    p[root] = null_id;
+
+    return typename graph<T, V, A>::path {
+        std::move(p),
+        std::move(level),
+        root
+    };
+}
+
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::path delta_stepping(
+    const graph<T, V, A>& G, 
+    typename graph<T, V, A>::id_type root, 
+    typename graph<T, V, A>::weight_type delta, 
+    unsigned threads
+)
+{
+    using id_type = typename graph<T, V, A>::id_type;
+    using weight_type = typename graph<T, V, A>::weight_type;
+
+    struct request
+    {
+        id_type node;
+        id_type parent;
+        weight_type distance;
+    };
+
+    const weight_type inf = std::numeric_limits<weight_type>::max();
+    const id_type null_id = graph<T, V, A>::null_id;
+    const size_t grain = 256;
+
+    threads = execution::concurrency(threads);
+    size_t n = G.capacity();
+
+    weight_type total = 0;
+    weight_type max_w = 0;
+    size_t m = 0;
+
+    for (id_type u = 0; u < n; ++u)
+    {
+        for (auto e : G.out_edges(u))
+        {
+            total += e.second;
+            max_w = std::max(max_w, e.second);
+            m++;
+        }
+    }
+
+    if (!(delta > 0))
+    {
+        delta = m > 0 ? total / static_cast<weight_type>(m) : 1;
+
+        if (!(delta > 0))
+        {
+            delta = std::is_integral<weight_type>::value ? 1 : std::numeric_limits<weight_type>::min();
+        }
+    }
+
+    // No distance is above the sum of the weights, so bucket numbers fit a size_t
+    const weight_type max_bucket = static_cast<weight_type>(std::numeric_limits<size_t>::max() / 4);
+
+    if (total / delta > max_bucket)
+    {
+        delta = total / max_bucket;
+    }
+
+    std::vector<weight_type> d(n, inf);
+    std::vector<id_type> p(n, null_id);
+    // A relaxation from bucket idx lands at most ceil(max_w / delta) buckets ahead,
+    // so the buckets are kept in a cyclic array of one more than that, up to n + 2.
+    // Nodes beyond the window wait in overflow, which is scanned again every time
+    // the window has moved by its whole size, or skipped to when the window is empty
+    const size_t window = max_w / delta < static_cast<weight_type>(n) ? static_cast<size_t>(max_w / delta) + 2 : n + 2;
+    std::vector<std::vector<id_type>> buckets(window);
+    std::vector<id_type> overflow;
+    size_t horizon = window;
+    size_t pending = 0;
+    std::vector<size_t> round(n, 0);
+    std::vector<size_t> settled(n, 0);
+    size_t round_id = 0;
+
+    // requests[src * threads + owner] holds the relaxations generated by thread src
+    // for nodes owned by thread owner, so that every node is only written by its owner.
+    std::vector<std::vector<request>> requests(threads * threads);
+    std::vector<std::vector<id_type>> improved(threads);
+    execution::thread_pool pool { threads };
+
+    auto bucket_of = [delta] (weight_type distance) { return static_cast<size_t>(distance / delta); };
+
+    auto push = [&] (size_t idx, id_type node) {
+        if (idx >= horizon)
+        {
+            overflow.push_back(node);
+            return;
+        }
+
+        buckets[idx % window].push_back(node);
+        pending++;
+    };
+
+    auto relax = [&] (const std::vector<id_type>& nodes, bool light) {
+        pool.parallel_for(nodes.size(), grain, [&] (size_t first, size_t last, unsigned idx) {
+            for (size_t k = first; k < last; ++k)
+            {
+                id_type u = nodes[k];
+
+                for (auto e : G.out_edges(u))
+                {
+                    if ((e.second <= delta) != light)
+                    {
+                        continue;
+                    }
+
+                    weight_type nd = d[u] + e.second;
+
+                    if (nd < d[e.first])
+                    {
+                        requests[idx * threads + e.first % threads].push_back({ e.first, u, nd });
+                    }
+                }
+            }
+        });
+
+        pool.parallel_for(threads, 1, [&] (size_t first, size_t last, unsigned) {
+            for (size_t owner = first; owner < last; ++owner)
+            {
+                for (unsigned src = 0; src < threads; ++src)
+                {
+                    for (const request& r : requests[src * threads + owner])
+                    {
+                        if (r.distance < d[r.node])
+                        {
+                            d[r.node] = r.distance;
+                            p[r.node] = r.parent;
+                            improved[owner].push_back(r.node);
+                        }
+                    }
+
+                    requests[src * threads + owner].clear();
+                }
+            }
+        });
+
+        for (auto& owned : improved)
+        {
+            for (id_type node : owned)
+            {
+                push(bucket_of(d[node]), node);
+            }
+
+            owned.clear();
+        }
+    };
+
+    d[root] = 0;
+    push(0, root);
+
+    for (size_t idx = 0; pending > 0 || !overflow.empty(); ++idx)
+    {
+        if (pending == 0 || idx == horizon)
+        {
+            // Overflow nodes whose distance is now below idx have been pushed again since
+            if (pending == 0)
+            {
+                size_t first = std::numeric_limits<size_t>::max();
+
+                for (id_type node : overflow)
+                {
+                    size_t b = bucket_of(d[node]);
+                    first = b >= idx ? std::min(first, b) : first;
+                }
+
+                if (first == std::numeric_limits<size_t>::max())
+                {
+                    break;
+                }
+
+                idx = first;
+            }
+
+            horizon = idx + window;
+            size_t kept = 0;
+
+            for (id_type node : overflow)
+            {
+                size_t b = bucket_of(d[node]);
+
+                if (b >= horizon)
+                {
+                    overflow[kept++] = node;
+                }
+                else if (b >= idx)
+                {
+                    push(b, node);
+                }
+            }
+
+            overflow.resize(kept);
+        }
+
+        std::vector<id_type>& bucket = buckets[idx % window];
+        std::vector<id_type> S;
+
+        while (!bucket.empty())
+        {
+            std::vector<id_type> R;
+            round_id++;
+
+            for (id_type node : bucket)
+            {
+                if (round[node] != round_id && bucket_of(d[node]) == idx)
+                {
+                    round[node] = round_id;
+                    R.push_back(node);
+
+                    if (settled[node] != idx + 1)
+                    {
+                        settled[node] = idx + 1;
+                        S.push_back(node);
+                    }
+                }
+            }
+
+            pending -= bucket.size();
+            bucket.clear();
+            relax(R, true);
+        }
+
+        relax(S, false);
+    }
+
+    return typename graph<T, V, A>::path {
+        std::move(p),
+        std::move(d),
+        root
+    };
+}
+
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::path bfs_distance(const graph<T, V, A>& G, typename graph<T, V, A>::id_type root, execution::sequenced_policy)
+{
+    return bfs_distance(G, root);
+}
+
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::path bfs_distance(const graph<T, V, A>& G, typename graph<T, V, A>::id_type root, const execution::parallel_policy& policy)
+{
+    return parallel_bfs_distance(G, root, policy.threads);
+}
+
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::path bellman_ford(const graph<T, V, A>& G, typename graph<T, V, A>::id_type root, execution::sequenced_policy)
+{
+    return bellman_ford(G, root);
+}
+
+template <typename T, typename V, typename A>
+inline typename graph<T, V, A>::path bellman_ford(const graph<T, V, A>& G, typename graph<T, V, A>::id_type root, const execution::parallel_policy& policy)
+{
+    if (G.has_negative_weights())
+    {
+        return bellman_ford(G, root);
+    }
+
+    return delta_stepping(G, root, static_cast<typename graph<T, V, A>::weight_type>(policy.delta), policy.threads);
+}
+
+namespace execution
+{
+
+template <typename iterator_type, typename T, typename V, typename A, typename policy_type>
+inline typename graph<T, V, A>::path operator>(const iterator_type& it, const bound_graph<T, V, A, policy_type>& G)
+{
+    if (*it == graph<T, V, A>::null_id)
+    {
+        return {};
+    }
+
+    if (!G.G.is_weighted())
+    {
+        return bfs_distance(G.G, *it, G.policy);
+    }
+
+    return bellman_ford(G.G, *it, G.policy);
+}
+
+} // namespace execution
+
+template <typename T, typename V, typename A>
+inline graph_builder<T, V, A>::graph_builder(unsigned shards)
+    : shards_(shards > 0 ? shards : 2 * execution::concurrency(0))
+{ }
+
+template <typename T, typename V, typename A>
+inline void graph_builder<T, V, A>::add_edge(id_type node, id_type child, weight_type w)
+{
+    shard& s = shards_[execution::thread_index() % shards_.size()];
+
+    while (s.busy.exchange(true, std::memory_order_acquire))
+    {
+        std::this_thread::yield();
+    }
+
+    s.edges.push_back({ node, child, w });
+    s.busy.store(false, std::memory_order_release);
+}
+
+template <typename T, typename V, typename A>
+inline void graph_builder<T, V, A>::reserve(size_type edges)
+{
+    for (shard& s : shards_)
+    {
+        s.edges.reserve(edges / shards_.size() + 1);
+    }
+}
+
+template <typename T, typename V, typename A>
+inline typename graph_builder<T, V, A>::size_type graph_builder<T, V, A>::size() const
+{
+    size_type count = 0;
+
+    for (const shard& s : shards_)
+    {
+        count += s.edges.size();
+    }
+
+    return count;
+}
+
+template <typename T, typename V, typename A>
+inline void graph_builder<T, V, A>::merge(graph<T, V, A>& G, bool symmetric, unsigned threads)
+{
+    threads = execution::concurrency(threads);
+
+    // Edges are split by node range, then every range is added by a single thread.
+    // Atomic counters per node would do without the split, but contended or not,
+    // atomic increments on cache missing lines cost several times a copy of the edge
+    size_type n = G.capacity();
+    size_type parts = std::max<size_type>(1, std::min<size_type>(n, 4 * threads));
+    size_type span = std::max<size_type>(1, (n + parts - 1) / parts);
+
+    // outs[s][p] has the edges of shard s leaving nodes of range p, ins[s][p] those entering it
+    std::vector<std::vector<std::vector<record>>> outs(shards_.size(), std::vector<std::vector<record>>(parts));
+    std::vector<std::vector<std::vector<record>>> ins(shards_.size(), std::vector<std::vector<record>>(parts));
+    std::atomic<bool> weighted { false };
+    std::atomic<bool> negative_weights { false };
+    size_type count = size();
+
+    execution::parallel_for(threads, shards_.size(), 1, [&] (size_t first, size_t last, unsigned) {
+        bool w1 = false;
+        bool neg = false;
+
+        for (size_t idx = first; idx < last; ++idx)
+        {
+            for (const record& e : shards_[idx].edges)
+            {
+                outs[idx][e.node / span].push_back(e);
+                ins[idx][e.child / span].push_back(e);
+
+                if (symmetric)
+                {
+                    outs[idx][e.child / span].push_back({ e.child, e.node, e.w });
+                    ins[idx][e.node / span].push_back({ e.child, e.node, e.w });
+                }
+
+                w1 = w1 || e.w != 1;
+                neg = neg || e.w < weight_type {};
+            }
+
+            std::vector<record>().swap(shards_[idx].edges);
+        }
+
+        if (w1)
+        {
+            weighted.store(true, std::memory_order_relaxed);
+        }
+
+        if (neg)
+        {
+            negative_weights.store(true, std::memory_order_relaxed);
+        }
+    });
+
+    // Only the default allocator is known to be safe to use from many threads
+    unsigned alloc_threads = std::is_same<A, std::allocator<T>>::value ? threads : 1;
+
+    execution::parallel_for(alloc_threads, parts, 1, [&] (size_t first, size_t last, unsigned) {
+        std::vector<size_type> out_degree(span);
+        std::vector<size_type> in_degree(span);
+
+        for (size_t p = first; p < last; ++p)
+        {
+            id_type lo = p * span;
+            id_type hi = std::min(n, lo + span);
+
+            std::fill(out_degree.begin(), out_degree.end(), 0);
+            std::fill(in_degree.begin(), in_degree.end(), 0);
+
+            for (size_t idx = 0; idx < shards_.size(); ++idx)
+            {
+                for (const record& e : outs[idx][p])
+                {
+                    out_degree[e.node - lo]++;
+                }
+
+                for (const record& e : ins[idx][p])
+                {
+                    in_degree[e.child - lo]++;
+                }
+            }
+
+            for (id_type node = lo; node < hi; ++node)
+            {
+                G.adjs_[node].reserve(G.adjs_[node].size() + out_degree[node - lo]);
+                G.ws_[node].reserve(G.ws_[node].size() + out_degree[node - lo]);
+                G.radjs_[node].reserve(G.radjs_[node].size() + in_degree[node - lo]);
+                G.rws_[node].reserve(G.rws_[node].size() + in_degree[node - lo]);
+            }
+
+            for (size_t idx = 0; idx < shards_.size(); ++idx)
+            {
+                for (const record& e : outs[idx][p])
+                {
+                    G.adjs_[e.node].push_back(e.child);
+                    G.ws_[e.node].push_back(e.w);
+                }
+
+                for (const record& e : ins[idx][p])
+                {
+                    G.radjs_[e.child].push_back(e.node);
+                    G.rws_[e.child].push_back(e.w);
+                }
+
+                std::vector<record>().swap(outs[idx][p]);
+                std::vector<record>().swap(ins[idx][p]);
+            }
+        }
+    });
+
+    G.edges_ += symmetric ? 2 * count : count;
+    G.weighted_ = weight_storage<V, A>::stored && (G.weighted_ || weighted.load());
+    G.negative_weights_ = weight_storage<V, A>::stored && (G.negative_weights_ || negative_weights.load());
+    G.version_++;
+}
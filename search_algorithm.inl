@@ -1,28 +1,341 @@
-template<typename T, typename V>
-class graph;
-
 namespace search_algorithm
 {
 
 struct graph_setter
 {
 public:
-    template<typename T, typename V>
-    void set_graph(const graph<T, V>&) { }
+    template<typename graph_type>
+    void set_graph(const graph_type&, bool = false) { }
 };
 
 template<typename container_type>
 struct graph_container : public container_type, public graph_setter
-{ };
+{
+public:
+    void clear() { this->c.clear(); }
+};
 
 template<>
 struct graph_container<std::queue<size_t>> : public std::queue<size_t>, public graph_setter
 {
 public:
     size_t top() const { return front(); }
+    void clear() { c.clear(); }
+};
+
+class lifo : public graph_setter
+{
+public:
+    void push(size_t node) { c_.push_back(node); }
+    void pop() { c_.pop_back(); }
+    size_t top() const { return c_.back(); }
+    bool empty() const { return c_.empty(); }
+    size_t size() const { return c_.size(); }
+    void clear() { c_.clear(); }
+
+private:
+    std::vector<size_t> c_;
+};
+
+class fifo : public graph_setter
+{
+public:
+    void push(size_t node);
+    void pop() { ++head_; }
+    size_t top() const { return c_[head_]; }
+    size_t front() const { return c_[head_]; }
+    bool empty() const { return head_ == c_.size(); }
+    size_t size() const { return c_.size() - head_; }
+    void clear() { c_.clear(); head_ = 0; }
+
+private:
+    std::vector<size_t> c_;
+    size_t head_ = 0;
+};
+
+inline void fifo::push(size_t node)
+{
+    if (head_ == c_.size())
+    {
+        clear();
+    }
+    else if (head_ >= 64 && head_ * 2 >= c_.size())
+    {
+        c_.erase(c_.begin(), c_.begin() + head_);
+        head_ = 0;
+    }
+
+    c_.push_back(node);
+}
+
+using dfs = lifo;
+using bfs = fifo;
+
+// Base for frontiers that need to look at edge weights.
+// It keeps track of the cost of the best known path to every node and
+// of the node being expanded, which is the parent of every node pushed after it.
+class weighted_graph_setter
+{
+public:
+    template<typename graph_type>
+    void set_graph(const graph_type& G, bool reversed = false)
+    {
+        G_ = &G;
+        weight_ = &weight_of<graph_type>;
+        reversed_ = reversed;
+
+        if (g_.size() < G.capacity())
+        {
+            g_.resize(G.capacity());
+        }
+
+        seen_.reserve(G.capacity());
+        closed_.reserve(G.capacity());
+    }
+
+protected:
+    static size_t none() { return std::numeric_limits<size_t>::max(); }
+
+    double cost_to(size_t node) const
+    {
+        if (from_ == none())
+        {
+            return 0;
+        }
+
+        return g_[from_] + weight_(G_, from_, node, cursor_, reversed_);
+    }
+
+    bool improves(size_t node, double g) const { return !closed_.contains(node) && (!seen_.contains(node) || g < g_[node]); }
+
+    void update(size_t node, double g)
+    {
+        seen_.insert(node);
+        g_[node] = g;
+    }
+
+    void expand(size_t node)
+    {
+        closed_.insert(node);
+        from_ = node;
+        cursor_ = 0;
+    }
+
+    void reset()
+    {
+        seen_.clear();
+        closed_.clear();
+        from_ = none();
+    }
+
+private:
+    // Children are pushed in adjacency order, so the weight of the next one
+    // is found by moving a cursor forward through the edges of the expanded node.
+    template<typename graph_type>
+    static double weight_of(const void* G, size_t node, size_t child, size_t& cursor, bool reversed)
+    {
+        const graph_type& g = *static_cast<const graph_type*>(G);
+        auto edges = reversed ? g.in_edges(node) : g.out_edges(node);
+
+        for (; cursor < edges.size(); ++cursor)
+        {
+            if (edges.target(cursor) == child)
+            {
+                return static_cast<double>(edges.weight(cursor++));
+            }
+        }
+
+        return static_cast<double>(reversed ? g.weight(child, node) : g.weight(node, child));
+    }
+
+protected:
+    std::vector<double> g_;
+    visited_set seen_;
+    visited_set closed_;
+    size_t from_ = none();
+
+private:
+    const void* G_ = nullptr;
+    double (*weight_)(const void*, size_t, size_t, size_t&, bool) = nullptr;
+    mutable size_t cursor_ = 0;
+    bool reversed_ = false;
+};
+
+struct zero_heuristic
+{
+    double operator()(size_t) const { return 0; }
 };
 
-using dfs = graph_container<std::stack<size_t>>;
-using bfs = graph_container<std::queue<size_t>>;
+// Expands nodes by increasing cost plus heuristic estimate.
+// When a goal is given, the visit stops right after reaching it.
+template<typename heuristic_type>
+class astar : public weighted_graph_setter
+{
+public:
+    astar(heuristic_type h = heuristic_type(), size_t goal = std::numeric_limits<size_t>::max())
+        : h_(h), goal_(goal)
+    { }
+
+public:
+    void push(size_t node);
+    void pop();
+    size_t top() const { return Q_.top().second; }
+    bool empty() const { return Q_.empty(); }
+    size_t size() const { return Q_.size(); }
+    void clear() { Q_.clear(); reset(); }
+
+private:
+    heuristic_type h_;
+    size_t goal_;
+    heap::binary::queue<double, size_t> Q_;
+};
+
+using ucs = astar<zero_heuristic>;
+
+template<typename heuristic_type>
+astar<heuristic_type> make_astar(heuristic_type h, size_t goal = std::numeric_limits<size_t>::max())
+{
+    return astar<heuristic_type> { h, goal };
+}
+
+// Level by level visit that only keeps the best width nodes of every level,
+// ranked by cost plus heuristic estimate.
+template<size_t width, typename heuristic_type = zero_heuristic>
+class beam : public weighted_graph_setter
+{
+    static_assert(width > 0, "Beam width must be positive");
+
+public:
+    beam(heuristic_type h = heuristic_type())
+        : h_(h)
+    { }
+
+public:
+    void push(size_t node);
+    void pop();
+    size_t top() const { promote(); return level_[head_].node; }
+    bool empty() const { promote(); return head_ == level_.size(); }
+    size_t size() const { return level_.size() - head_ + next_.size(); }
+    void clear();
+
+private:
+    struct entry
+    {
+        double score;
+        double g;
+        size_t node;
+
+        bool operator<(const entry& other) const { return score < other.score; }
+    };
+
+    bool is_live(const entry& e) const { return !closed_.contains(e.node) && e.g == g_[e.node]; }
+    void promote() const;
+
+private:
+    heuristic_type h_;
+    mutable std::vector<entry> level_;
+    mutable std::vector<entry> next_;
+    mutable size_t head_ = 0;
+};
+
+template<typename heuristic_type>
+inline void astar<heuristic_type>::push(size_t node)
+{
+    if (goal_ != none() && from_ == goal_)
+    {
+        return;
+    }
+
+    double g = cost_to(node);
+
+    if (!improves(node, g))
+    {
+        return;
+    }
+
+    update(node, g);
+    Q_.push(g + h_(node), node);
+}
+
+template<typename heuristic_type>
+inline void astar<heuristic_type>::pop()
+{
+    size_t node = top();
+    Q_.pop();
+    expand(node);
+
+    if (node == goal_)
+    {
+        Q_.clear();
+    }
+
+    while (!Q_.empty() && closed_.contains(Q_.top().second))
+    {
+        Q_.pop();
+    }
+}
+
+template<size_t width, typename heuristic_type>
+inline void beam<width, heuristic_type>::push(size_t node)
+{
+    double g = cost_to(node);
+
+    if (!improves(node, g))
+    {
+        return;
+    }
+
+    update(node, g);
+    (from_ == none() ? level_ : next_).push_back({ g + h_(node), g, node });
+}
+
+template<size_t width, typename heuristic_type>
+inline void beam<width, heuristic_type>::pop()
+{
+    promote();
+    expand(level_[head_++].node);
+}
+
+template<size_t width, typename heuristic_type>
+inline void beam<width, heuristic_type>::clear()
+{
+    level_.clear();
+    next_.clear();
+    head_ = 0;
+    reset();
+}
+
+template<size_t width, typename heuristic_type>
+inline void beam<width, heuristic_type>::promote() const
+{
+    while (head_ < level_.size() && !is_live(level_[head_]))
+    {
+        ++head_;
+    }
+
+    if (head_ < level_.size() || next_.empty())
+    {
+        return;
+    }
+
+    std::stable_sort(next_.begin(), next_.end());
+    level_.clear();
+    head_ = 0;
+
+    for (const entry& e : next_)
+    {
+        if (level_.size() == width)
+        {
+            break;
+        }
+
+        if (is_live(e))
+        {
+            level_.push_back(e);
+        }
+    }
+
+    next_.clear();
+}
 
-} // namespace search_algorithm
\ No newline at end of file
+} // namespace search_algorithm
@@ -0,0 +1,407 @@
+// Visit shared by every graph type: graph, csr_graph and graph_snapshot all use it as their
+// search_iterator. graph_type must expose in(), out(), in_edges(), out_edges(), capacity(),
+// and the path calculations shortest_path() and shortest_paths() the operators below rely on.
+template <typename graph_type, typename container_type, typename stats_type = null_stats>
+class basic_search_iterator
+{
+public:
+    using id_type = typename graph_type::id_type;
+    using weight_type = typename graph_type::weight_type;
+    using path = typename graph_type::path;
+    using path_array = typename graph_type::path_array;
+
+public:
+    basic_search_iterator(
+        const graph_type& G,
+        bool reversed,
+        id_type root = graph_type::null_id,
+        const container_type& frontier = container_type()
+    ) : G_(G), reversed_(reversed), own_(frontier), curr_(root), root_(root), ws_(&own_), stats_(&own_stats_)
+    {
+        start(root_);
+    }
+
+    basic_search_iterator(
+        const graph_type& G,
+        bool reversed,
+        id_type root,
+        traversal_workspace<container_type>& workspace
+    ) : G_(G), reversed_(reversed), curr_(root), root_(root), ws_(&workspace), stats_(&own_stats_)
+    {
+        start(root_);
+    }
+
+    basic_search_iterator(
+        const graph_type& G,
+        bool reversed,
+        id_type root,
+        traversal_workspace<container_type>& workspace,
+        stats_type& stats
+    ) : G_(G), reversed_(reversed), curr_(root), root_(root), ws_(&workspace), stats_(&stats)
+    {
+        start(root_);
+    }
+
+    // A copy restarts the visit from the current node in a workspace of its own,
+    // so that a workspace passed by the caller is never shared by two iterators
+    basic_search_iterator(const basic_search_iterator& it)
+        : G_(it.G_), reversed_(it.reversed_), own_(it.ws_->frontier),
+          curr_(it.curr_), root_(it.root_), ws_(&own_),
+          stats_(it.stats_ == &it.own_stats_ ? &own_stats_ : it.stats_)
+    {
+        start(curr_);
+    }
+
+public:
+    id_type operator*() const { return curr_; }
+    basic_search_iterator& operator++();
+    weight_type operator-(const basic_search_iterator& other) const;
+    path_array operator<(const basic_search_iterator& other) const;
+    path_array operator>(const basic_search_iterator& other) const { return other < *this; }
+    path operator>(const graph_type&) const;
+
+    template <typename other_stats_type>
+    bool operator==(const basic_search_iterator<graph_type, container_type, other_stats_type>& other) const { return curr_ == *other; }
+
+    template <typename other_stats_type>
+    bool operator!=(const basic_search_iterator<graph_type, container_type, other_stats_type>& other) const { return !(*this == other); }
+
+    void prune() { prune_ = true; }
+    void rewind();
+
+    id_type peek() const { return ws_->frontier.empty() ? graph_type::null_id : ws_->frontier.top(); }
+
+private:
+    void start(id_type node);
+    void step();
+
+private:
+    const graph_type& G_;
+    bool reversed_;
+    traversal_workspace<container_type> own_;
+    id_type curr_;
+    id_type root_;
+    traversal_workspace<container_type>* ws_;
+    stats_type own_stats_;
+    stats_type* stats_;
+    bool prune_ = false;
+};
+
+template <typename graph_type, typename container_type, typename stats_type>
+void basic_search_iterator<graph_type, container_type, stats_type>::rewind()
+{
+    curr_ = root_;
+    prune_ = false;
+    start(root_);
+}
+
+template <typename graph_type, typename container_type, typename stats_type>
+inline void basic_search_iterator<graph_type, container_type, stats_type>::start(id_type node)
+{
+    if (node == graph_type::null_id)
+    {
+        return;
+    }
+
+    ws_->frontier.clear();
+    ws_->visited.reserve(G_.capacity());
+    ws_->visited.clear();
+    ws_->frontier.set_graph(G_, reversed_);
+    ws_->frontier.push(node);
+    step();
+}
+
+template <typename graph_type, typename container_type, typename stats_type>
+inline void basic_search_iterator<graph_type, container_type, stats_type>::step()
+{
+    container_type& frontier = ws_->frontier;
+    visited_set& E = ws_->visited;
+
+    curr_ = graph_type::null_id;
+
+    while (!frontier.empty())
+    {
+        id_type node = frontier.top();
+        frontier.pop();
+        stats_->lookup();
+
+        if (E.insert(node))
+        {
+            curr_ = node;
+            stats_->expand();
+            break;
+        }
+    }
+
+    if (curr_ != graph_type::null_id && !prune_)
+    {
+        const auto& children = reversed_ ? G_.in(curr_) : G_.out(curr_);
+
+        stats_->scan(children.size());
+        stats_->lookup(children.size());
+
+        for (id_type child : children)
+        {
+            if (!E.contains(child))
+            {
+                frontier.push(child);
+            }
+        }
+
+        stats_->frontier(frontier.size());
+
+        while (!frontier.empty() && E.contains(frontier.top()))
+        {
+            frontier.pop();
+            stats_->lookup();
+        }
+    }
+
+    prune_ = false;
+}
+
+template <typename graph_type, typename container_type, typename stats_type>
+inline basic_search_iterator<graph_type, container_type, stats_type>& basic_search_iterator<graph_type, container_type, stats_type>::operator++()
+{
+    step();
+    return *this;
+}
+
+template <typename graph_type, typename container_type, typename stats_type>
+inline typename graph_type::weight_type basic_search_iterator<graph_type, container_type, stats_type>::operator-(const basic_search_iterator& other) const
+{
+    if (*other == graph_type::null_id || curr_ == graph_type::null_id)
+    {
+        return std::numeric_limits<weight_type>::max();
+    }
+
+    return G_.shortest_path(*other, curr_).second;
+}
+
+template <typename graph_type, typename container_type, typename stats_type>
+inline typename graph_type::path_array basic_search_iterator<graph_type, container_type, stats_type>::operator<(const basic_search_iterator& other) const
+{
+    if (*other == graph_type::null_id || curr_ == graph_type::null_id)
+    {
+        return {};
+    }
+
+    return G_.shortest_path(*other, curr_).first;
+}
+
+template <typename graph_type, typename container_type, typename stats_type>
+inline typename graph_type::path basic_search_iterator<graph_type, container_type, stats_type>::operator>(const graph_type&) const
+{
+    if (curr_ == graph_type::null_id)
+    {
+        return {};
+    }
+
+    return *G_.shortest_paths(curr_);
+}
+
+// Path calculations written once for every graph type, which the bfs_distance,
+// bellman_ford, dijkstra and weight of each graph type call
+namespace sssp
+{
+
+template <typename graph_type, typename stats_type>
+inline typename graph_type::path bfs(const graph_type& G, typename graph_type::id_type root, stats_type& stats)
+{
+    using id_type = typename graph_type::id_type;
+    using weight_type = typename graph_type::weight_type;
+
+    stats.begin_phase("init");
+
+    std::vector<weight_type> level(G.capacity(), std::numeric_limits<weight_type>::max());
+    std::vector<id_type> p(G.capacity(), graph_type::null_id);
+    std::vector<id_type> frontier;
+
+    frontier.reserve(G.order());
+    frontier.push_back(root);
+    level[root] = 0;
+
+    stats.end_phase();
+    stats.begin_phase("search");
+
+    for (size_t head = 0; head < frontier.size(); ++head)
+    {
+        id_type node = frontier[head];
+        const auto& children = G.out(node);
+
+        stats.expand();
+        stats.scan(children.size());
+        stats.lookup(children.size());
+
+        for (id_type child : children)
+        {
+            if (level[child] != std::numeric_limits<weight_type>::max())
+            {
+                continue;
+            }
+
+            level[child] = level[node] + 1;
+            p[child] = node;
+            frontier.push_back(child);
+        }
+
+        stats.frontier(frontier.size() - head - 1);
+    }
+
+    stats.end_phase();
+
+    return typename graph_type::path {
+        std::move(p),
+        std::move(level),
+        root
+    };
+}
+
+template <typename graph_type, typename stats_type>
+inline typename graph_type::path bellman_ford(const graph_type& G, typename graph_type::id_type root, stats_type& stats)
+{
+    using id_type = typename graph_type::id_type;
+    using weight_type = typename graph_type::weight_type;
+
+    stats.begin_phase("init");
+
+    std::vector<weight_type> d(G.capacity(), std::numeric_limits<weight_type>::max());
+    std::vector<id_type> p(G.capacity(), graph_type::null_id);
+
+    d[root] = 0;
+
+    stats.end_phase();
+
+    for (size_t bfstep = 1; bfstep < G.order(); ++bfstep)
+    {
+        bool relaxed = false;
+
+        stats.begin_phase("pass");
+        stats.pass();
+
+        for (id_type u = 0; u < G.capacity(); ++u)
+        {
+            if (d[u] == std::numeric_limits<weight_type>::max())
+            {
+                continue;
+            }
+
+            auto edges = G.out_edges(u);
+
+            stats.expand();
+            stats.scan(edges.size());
+
+            for (auto e : edges)
+            {
+                if (d[u] + e.second < d[e.first])
+                {
+                    d[e.first] = d[u] + e.second;
+                    p[e.first] = u;
+                    relaxed = true;
+                    stats.relax();
+                }
+            }
+        }
+
+        stats.end_phase();
+
+        if (!relaxed)
+        {
+            break;
+        }
+    }
+
+    return typename graph_type::path {
+        std::move(p),
+        std::move(d),
+        root
+    };
+}
+
+template <typename queue_type, typename graph_type>
+inline typename graph_type::path dijkstra(const graph_type& G, typename graph_type::id_type root)
+{
+    using id_type = typename graph_type::id_type;
+    using weight_type = typename graph_type::weight_type;
+
+    std::vector<weight_type> d(G.capacity(), std::numeric_limits<weight_type>::max());
+    std::vector<id_type> p(G.capacity(), graph_type::null_id);
+    typename queue_type::template queue<weight_type, id_type> Q;
+
+    d[root] = 0;
+    Q.push(0, root);
+
+    while (!Q.empty())
+    {
+        weight_type du = Q.top().first;
+        id_type u = Q.top().second;
+        Q.pop();
+
+        if (d[u] < du)
+        {
+            continue;
+        }
+
+        for (auto e : G.out_edges(u))
+        {
+            id_type v = e.first;
+            weight_type dv = du + e.second;
+
+            if (dv < d[v])
+            {
+                d[v] = dv;
+                p[v] = u;
+                Q.push(dv, v);
+            }
+        }
+    }
+
+    return typename graph_type::path {
+        std::move(p),
+        std::move(d),
+        root
+    };
+}
+
+// BFS on unweighted graphs, Dijkstra when all weights are non-negative, Bellman-Ford otherwise
+template <typename graph_type>
+inline typename graph_type::path solve(const graph_type& G, typename graph_type::id_type root)
+{
+    null_stats stats;
+
+    if (!G.is_weighted())
+    {
+        return bfs(G, root, stats);
+    }
+
+    if (G.has_negative_weights())
+    {
+        return bellman_ford(G, root, stats);
+    }
+
+    return dijkstra<heap::preferred<typename graph_type::weight_type>>(G, root);
+}
+
+// Last of the parallel edges from node to child, as graph::edge keeps adding them
+template <typename graph_type>
+inline typename graph_type::weight_type weight(const graph_type& G, typename graph_type::id_type node, typename graph_type::id_type child)
+{
+    if (node >= G.capacity())
+    {
+        return std::numeric_limits<typename graph_type::weight_type>::max();
+    }
+
+    auto edges = G.out_edges(node);
+
+    for (size_t idx = edges.size(); idx-- > 0;)
+    {
+        if (edges.target(idx) == child)
+        {
+            return edges.weight(idx);
+        }
+    }
+
+    return std::numeric_limits<typename graph_type::weight_type>::max();
+}
+
+} // namespace sssp
@@ -0,0 +1,536 @@
+// MIT License
+
+// graph - http://www.github/ilariom/graph
+// Copyright (c) 2020 - Ilario Mangano
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Tests of the graph kernels. Build and run from the repository root:
+//
+//     g++ -std=c++11 -pthread -I. test/algorithm_test.cpp -o algorithm_test && ./algorithm_test
+
+#undef NDEBUG
+
+#include "algorithm.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+using graph_type = estd::digraph<int>;
+
+graph_type make_graph(size_t n)
+{
+    graph_type G;
+    std::vector<int> values(n);
+    G.insert(values.begin(), values.end());
+
+    return G;
+}
+
+void parallel_wcc_matches_serial()
+{
+    std::mt19937 rng { 1 };
+
+    for (size_t n : { 1, 50, 2000 })
+    {
+        // Few edges per node, so that there are many components of different sizes
+        for (size_t m : { n / 2, n, 2 * n })
+        {
+            graph_type G = make_graph(n);
+            std::uniform_int_distribution<size_t> node(0, n - 1);
+
+            for (size_t k = 0; k < m; ++k)
+            {
+                G.edge(node(rng), node(rng));
+            }
+
+            for (size_t k = 0; k < n / 10; ++k)
+            {
+                G.erase(node(rng));
+            }
+
+            estd::components expected = estd::weakly_connected_components(G);
+
+            for (unsigned threads : { 1u, 4u })
+            {
+                estd::components C = estd::parallel_weakly_connected_components(G, threads);
+
+                assert(C.count == expected.count);
+                assert(C.of == expected.of);
+            }
+        }
+    }
+}
+
+void scc_of_known_graph()
+{
+    // { 0, 1, 2 } -> { 3, 4 } -> { 6 }, with 5 alone and 7 erased
+    graph_type G = make_graph(8);
+
+    G.edge(0, 1);
+    G.edge(1, 2);
+    G.edge(2, 0);
+    G.edge(2, 3);
+    G.edge(3, 4);
+    G.edge(4, 3);
+    G.edge(4, 6);
+    G.edge(6, 7);
+    G.erase(7);
+
+    estd::components C = estd::strongly_connected_components(G);
+    const std::vector<size_t>& of = C.of;
+
+    assert(C.count == 4);
+    assert(of[0] == of[1] && of[1] == of[2]);
+    assert(of[3] == of[4]);
+    assert(of[0] != of[3] && of[0] != of[5] && of[0] != of[6]);
+    assert(of[3] != of[5] && of[3] != of[6] && of[5] != of[6]);
+    assert(of[0] > of[3] && of[3] > of[6]);
+    assert(of[7] == graph_type::null_id);
+
+    // A cycle too long for a recursive visit
+    const size_t n = 200000;
+    graph_type ring = make_graph(n);
+
+    for (size_t node = 0; node < n; ++node)
+    {
+        ring.edge(node, (node + 1) % n);
+    }
+
+    C = estd::strongly_connected_components(ring);
+    assert(C.count == 1);
+
+    ring.erase(n - 1, 0);
+    C = estd::strongly_connected_components(ring);
+    assert(C.count == n);
+}
+
+void topological_sort_rejects_cycles()
+{
+    graph_type G = make_graph(6);
+
+    G.edge(5, 2);
+    G.edge(5, 0);
+    G.edge(4, 0);
+    G.edge(4, 1);
+    G.edge(2, 3);
+    G.edge(3, 1);
+
+    std::vector<size_t> order;
+    assert(estd::topological_sort(G, order));
+    assert(order.size() == 6);
+
+    std::vector<size_t> position(6);
+
+    for (size_t idx = 0; idx < order.size(); ++idx)
+    {
+        position[order[idx]] = idx;
+    }
+
+    for (size_t node = 0; node < 6; ++node)
+    {
+        for (size_t child : G.out(node))
+        {
+            assert(position[node] < position[child]);
+        }
+    }
+
+    G.edge(1, 5);
+    assert(!estd::topological_sort(G, order));
+    assert(order.empty());
+
+    graph_type loop = make_graph(1);
+    loop.edge(0, 0);
+    assert(!estd::topological_sort(loop, order));
+}
+
+using weighted_type = estd::weighted_digraph<int, long>;
+
+// Random graph with weights in [0, max_weight], shifted by potential[u] - potential[v]
+// for the edge u -> v when shift is given: cycles keep their weight, so some edges
+// become negative without making negative cycles
+weighted_type random_weighted(std::mt19937& rng, size_t n, size_t m, long max_weight, long shift = 0)
+{
+    weighted_type G;
+    std::vector<int> values(n);
+    G.insert(values.begin(), values.end());
+
+    std::uniform_int_distribution<size_t> node(0, n - 1);
+    std::uniform_int_distribution<long> weight(0, max_weight);
+    std::uniform_int_distribution<long> offset(0, shift);
+    std::vector<long> potential(n);
+
+    for (long& h : potential)
+    {
+        h = offset(rng);
+    }
+
+    for (size_t k = 0; k < m; ++k)
+    {
+        size_t u = node(rng);
+        size_t v = node(rng);
+
+        G.edge(u, v, weight(rng) + potential[u] - potential[v]);
+    }
+
+    for (size_t k = 0; k < n / 10; ++k)
+    {
+        G.erase(node(rng));
+    }
+
+    return G;
+}
+
+void check_matrix(const weighted_type& G, const estd::distance_matrix<long>& M, bool paths)
+{
+    const long inf = std::numeric_limits<long>::max();
+
+    assert(M.size() == G.capacity());
+    assert(M.has_paths() == paths);
+    assert(!M.has_negative_cycle());
+
+    for (size_t u = 0; u < G.capacity(); ++u)
+    {
+        if (!G.is_valid(u))
+        {
+            continue;
+        }
+
+        weighted_type::path expected = estd::sssp::solve(G, u);
+
+        for (size_t v = 0; v < G.capacity(); ++v)
+        {
+            if (!G.is_valid(v))
+            {
+                continue;
+            }
+
+            assert(M.distance(u, v) == expected.distance_to(v));
+            assert(M.row(u)[v] == M.distance(u, v));
+
+            if (!paths)
+            {
+                assert(M.next_hop(u, v) == M.null_id && M.path(u, v).empty());
+                continue;
+            }
+
+            std::vector<size_t> p = M.path(u, v);
+
+            if (M.distance(u, v) == inf)
+            {
+                assert(p.empty());
+                continue;
+            }
+
+            assert(!p.empty() && p.front() == u && p.back() == v);
+
+            long total = 0;
+
+            for (size_t idx = 1; idx < p.size(); ++idx)
+            {
+                long best = inf;
+
+                for (auto e : G.out_edges(p[idx - 1]))
+                {
+                    best = e.first == p[idx] && e.second < best ? e.second : best;
+                }
+
+                assert(best != inf);
+                total += best;
+            }
+
+            assert(total == M.distance(u, v));
+        }
+    }
+}
+
+void apsp_matches_single_source()
+{
+    std::mt19937 rng { 2 };
+
+    // Sizes around the 64 nodes tiles of Floyd-Warshall
+    for (size_t n : { 1, 63, 64, 65, 200 })
+    {
+        for (long shift : { 0L, 10L })
+        {
+            weighted_type G = random_weighted(rng, n, 3 * n, 9, shift);
+            assert(G.has_negative_weights() == (shift > 0 && n > 1));
+
+            for (bool paths : { false, true })
+            {
+                for (unsigned threads : { 1u, 3u })
+                {
+                    check_matrix(G, estd::floyd_warshall(G, paths, threads), paths);
+                    check_matrix(G, estd::johnson(G, paths, threads), paths);
+                    check_matrix(G, estd::all_pairs_shortest_paths(G, paths, threads), paths);
+                }
+            }
+        }
+    }
+}
+
+void apsp_finds_negative_cycles()
+{
+    std::mt19937 rng { 3 };
+
+    for (size_t n : { 3, 65 })
+    {
+        weighted_type G = random_weighted(rng, n, 2 * n, 9);
+
+        // a -> b -> a costs -1
+        size_t a = *G.nodes_begin();
+        size_t b = *++G.nodes_begin();
+
+        G.edge(a, b, 4);
+        G.edge(b, a, -5);
+
+        assert(estd::floyd_warshall(G).has_negative_cycle());
+        assert(estd::johnson(G).has_negative_cycle());
+        assert(estd::all_pairs_shortest_paths(G, true, 2).has_negative_cycle());
+    }
+}
+
+bool near(double a, double b)
+{
+    return std::abs(a - b) < 1e-6;
+}
+
+double sum(const std::vector<double>& scores)
+{
+    double total = 0;
+
+    for (double x : scores)
+    {
+        total += x;
+    }
+
+    return total;
+}
+
+graph_type make_cycle(size_t n)
+{
+    graph_type G = make_graph(n);
+
+    for (size_t node = 0; node < n; ++node)
+    {
+        G.edge(node, (node + 1) % n);
+    }
+
+    return G;
+}
+
+// Leaves 1..k point to the center 0, which has no out edges
+graph_type make_star(size_t k)
+{
+    graph_type G = make_graph(k + 1);
+
+    for (size_t leaf = 1; leaf <= k; ++leaf)
+    {
+        G.edge(leaf, 0);
+    }
+
+    return G;
+}
+
+void pagerank_of_known_graphs()
+{
+    const double d = 0.85;
+    const size_t n = 10;
+
+    for (unsigned threads : { 1u, 3u })
+    {
+        estd::ranking R = estd::pagerank(make_cycle(n), d, 1e-12, 1000, threads);
+
+        for (double x : R.score)
+        {
+            assert(near(x, 1.0 / n));
+        }
+
+        // The center gives its score back to every node: leaves get 1 / (k (1 + d) + 1)
+        const size_t k = 5;
+        R = estd::pagerank(make_star(k), d, 1e-12, 1000, threads);
+
+        assert(near(sum(R.score), 1));
+        assert(near(R.score[0], (d * k + 1) / (k * (1 + d) + 1)));
+
+        for (size_t leaf = 1; leaf <= k; ++leaf)
+        {
+            assert(near(R.score[leaf], 1 / (k * (1 + d) + 1)));
+        }
+
+        // Jumping back to 0 only, the node k hops ahead of it gets (1 - d) d^k / (1 - d^n)
+        R = estd::personalized_pagerank(make_cycle(n), { 0 }, d, 1e-12, 1000, threads);
+
+        for (size_t node = 0; node < n; ++node)
+        {
+            assert(near(R.score[node], (1 - d) * std::pow(d, node) / (1 - std::pow(d, n))));
+        }
+    }
+}
+
+void pagerank_sums_to_one()
+{
+    std::mt19937 rng { 4 };
+    const size_t n = 500;
+
+    // Few edges leave many nodes without out edges
+    graph_type G = make_graph(n);
+    std::uniform_int_distribution<size_t> node(0, n - 1);
+
+    for (size_t k = 0; k < n; ++k)
+    {
+        G.edge(node(rng), node(rng));
+    }
+
+    std::vector<size_t> erased;
+
+    for (size_t k = 0; k < n; k += 9)
+    {
+        erased.push_back(k);
+    }
+
+    G.erase(erased);
+
+    estd::ranking R = estd::pagerank(G, 0.85, 1e-10, 1000, 4);
+
+    assert(R.error < 1e-10);
+    assert(near(sum(R.score), 1));
+
+    for (size_t k : erased)
+    {
+        assert(R.score[k] == 0);
+    }
+
+    // No valid source: jumps go anywhere, as in pagerank
+    for (const std::vector<size_t>& sources : { std::vector<size_t> {}, std::vector<size_t> { 0, 9, n + 3 } })
+    {
+        estd::ranking P = estd::personalized_pagerank(G, sources, 0.85, 1e-10, 1000, 4);
+
+        assert(near(sum(P.score), 1));
+
+        for (size_t k = 0; k < n; ++k)
+        {
+            assert(near(P.score[k], R.score[k]));
+        }
+    }
+
+    estd::ranking P = estd::personalized_pagerank(G, { 1, 2, 3 }, 0.85, 1e-10, 1000, 4);
+    assert(near(sum(P.score), 1));
+
+    // A few more edges and nodes: starting from the old scores converges to the same ones, sooner
+    for (size_t k = 0; k < 10; ++k)
+    {
+        G.insert(0);
+    }
+
+    for (size_t k = 0; k < 20; ++k)
+    {
+        size_t u = node(rng);
+        size_t v = node(rng);
+
+        if (G.is_valid(u) && G.is_valid(v))
+        {
+            G.edge(u, v);
+        }
+    }
+
+    estd::ranking cold = estd::pagerank(G, 0.85, 1e-10, 1000, 2);
+    estd::ranking warm = estd::pagerank(G, R, 0.85, 1e-10, 1000, 2);
+
+    assert(near(sum(warm.score), 1));
+    assert(warm.iterations <= cold.iterations);
+
+    for (size_t k = 0; k < G.capacity(); ++k)
+    {
+        assert(near(warm.score[k], cold.score[k]));
+    }
+
+    estd::ranking warm_p = estd::personalized_pagerank(G, { 1, 2, 3 }, P, 0.85, 1e-10, 1000, 2);
+    assert(near(sum(warm_p.score), 1));
+}
+
+void centrality_of_known_graphs()
+{
+    const size_t k = 5;
+    graph_type star = make_star(k);
+
+    std::vector<double> degree = estd::degree_centrality(star);
+    std::vector<double> closeness = estd::closeness_centrality(star, 2);
+
+    // The center is next to every node, and reached by all of them, leaves reach it alone
+    assert(near(degree[0], 1) && near(closeness[0], 1));
+
+    for (size_t leaf = 1; leaf <= k; ++leaf)
+    {
+        assert(near(degree[leaf], 1.0 / k) && closeness[leaf] == 0);
+    }
+
+    // On a cycle of n, every node is reached by the others at 1, 2, ..., n - 1 hops
+    const size_t n = 8;
+    graph_type cycle = make_cycle(n);
+
+    for (double x : estd::closeness_centrality(cycle, 3))
+    {
+        assert(near(x, 2.0 / n));
+    }
+
+    // Weights of 2 double the distances
+    weighted_type weighted;
+
+    for (size_t node = 0; node < n; ++node)
+    {
+        weighted.insert(0);
+    }
+
+    for (size_t node = 0; node < n; ++node)
+    {
+        weighted.edge(node, (node + 1) % n, 2);
+    }
+
+    for (double x : estd::closeness_centrality(weighted, 3))
+    {
+        assert(near(x, 1.0 / n));
+    }
+}
+
+} // namespace
+
+int main()
+{
+    parallel_wcc_matches_serial();
+    scc_of_known_graph();
+    topological_sort_rejects_cycles();
+    apsp_matches_single_source();
+    apsp_finds_negative_cycles();
+    pagerank_of_known_graphs();
+    pagerank_sums_to_one();
+    centrality_of_known_graphs();
+
+    std::printf("algorithm_test: ok\n");
+
+    return 0;
+}
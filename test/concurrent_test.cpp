@@ -0,0 +1,152 @@
+// MIT License
+
+// graph - http://www.github/ilariom/graph
+// Copyright (c) 2020 - Ilario Mangano
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Tests of concurrent_graph. Build and run from the repository root:
+//
+//     g++ -std=c++11 -pthread -I. test/concurrent_test.cpp -o concurrent_test && ./concurrent_test
+//
+// Adding -fsanitize=thread checks readers and writer for data races.
+
+#undef NDEBUG
+
+#include "concurrent_graph.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using graph_type = estd::concurrent_graph<int, long>;
+
+// Every edge is in the out list of its node and the in list of its child, so
+// both sums over the valid nodes of a consistent version give its size
+void check_snapshot(const graph_type::snapshot& S)
+{
+    size_t outs = 0;
+    size_t ins = 0;
+    size_t order = 0;
+
+    for (size_t node = 0; node < S.capacity(); ++node)
+    {
+        if (S.is_valid(node))
+        {
+            outs += S.out(node).size();
+            ins += S.in(node).size();
+            order++;
+        }
+    }
+
+    assert(outs == S.size());
+    assert(ins == S.size());
+    assert(order == S.order());
+}
+
+void readers_see_whole_versions()
+{
+    const unsigned readers = 4;
+    const size_t batches = 300;
+
+    graph_type G;
+    std::atomic<bool> done { false };
+    std::vector<std::thread> workers;
+
+    for (unsigned t = 0; t < readers; ++t)
+    {
+        workers.emplace_back([&G, &done] {
+            size_t last = 0;
+
+            while (!done.load())
+            {
+                graph_type::snapshot S = G.read();
+                assert(S.version() >= last);
+                last = S.version();
+                check_snapshot(S);
+            }
+
+            check_snapshot(G.read());
+        });
+    }
+
+    std::mt19937 rng { 1 };
+    std::vector<size_t> nodes;
+
+    for (size_t batch = 0; batch < batches; ++batch)
+    {
+        // Enough new nodes to add blocks and grow the block array while readers hold older ones
+        for (int k = 0; k < 8; ++k)
+        {
+            nodes.push_back(G.insert(k));
+        }
+
+        std::uniform_int_distribution<size_t> pick(0, nodes.size() - 1);
+
+        for (int k = 0; k < 40; ++k)
+        {
+            G.edge(nodes[pick(rng)], nodes[pick(rng)], k);
+        }
+
+        for (int k = 0; k < 4; ++k)
+        {
+            G.erase(nodes[pick(rng)], nodes[pick(rng)]);
+        }
+
+        for (int k = 0; k < 3; ++k)
+        {
+            size_t idx = pick(rng);
+            G.erase(nodes[idx]);
+            nodes[idx] = nodes.back();
+            nodes.pop_back();
+        }
+
+        size_t version = G.publish();
+        assert(G.read().version() == version);
+    }
+
+    done.store(true);
+
+    for (std::thread& w : workers)
+    {
+        w.join();
+    }
+
+    graph_type::snapshot S = G.read();
+    check_snapshot(S);
+    assert(S.size() == G.size() && S.order() == G.order() && S.order() == nodes.size());
+}
+
+} // namespace
+
+int main()
+{
+    readers_see_whole_versions();
+
+    std::printf("concurrent_test: ok\n");
+
+    return 0;
+}
@@ -0,0 +1,421 @@
+// MIT License
+
+// graph - http://www.github/ilariom/graph
+// Copyright (c) 2020 - Ilario Mangano
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Tests of graph storage and id bookkeeping. Build and run from the repository root:
+//
+//     g++ -std=c++11 -pthread -I. test/graph_test.cpp -o graph_test && ./graph_test
+
+#undef NDEBUG
+
+#include "graph.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+using graph_type = estd::weighted_digraph<int, long>;
+
+// Node k holds 10 k, and the edge u -> v weighs 100 u + v, so that both
+// can be told apart after ids move
+graph_type make_graph(std::mt19937& rng, size_t n, size_t m)
+{
+    graph_type G;
+    std::uniform_int_distribution<size_t> node(0, n - 1);
+
+    for (size_t k = 0; k < n; ++k)
+    {
+        G.insert(static_cast<int>(10 * k));
+    }
+
+    for (size_t k = 0; k < m; ++k)
+    {
+        size_t u = node(rng);
+        size_t v = node(rng);
+        G.edge(u, v, static_cast<long>(100 * u + v));
+    }
+
+    return G;
+}
+
+std::vector<size_t> erase_some(std::mt19937& rng, graph_type& G, size_t count)
+{
+    std::uniform_int_distribution<size_t> node(0, G.capacity() - 1);
+    std::vector<size_t> erased;
+
+    while (erased.size() < count)
+    {
+        size_t k = node(rng);
+
+        if (std::find(erased.begin(), erased.end(), k) == erased.end())
+        {
+            erased.push_back(k);
+        }
+    }
+
+    G.erase(erased);
+
+    return erased;
+}
+
+// Sorted (adjacent node, weight) pairs of a list of nodes adjacent to node, with ids
+// translated by remap, and weights read in the direction the list goes
+std::vector<std::pair<size_t, long>> mapped_edges(
+    const graph_type& G, 
+    size_t node, 
+    bool out, 
+    const graph_type::id_map& remap
+)
+{
+    std::vector<std::pair<size_t, long>> edges;
+
+    for (size_t other : out ? G.out(node) : G.in(node))
+    {
+        long w = out ? G.weight(node, other) : G.weight(other, node);
+        edges.emplace_back(remap.empty() ? other : remap[other], w);
+    }
+
+    std::sort(edges.begin(), edges.end());
+
+    return edges;
+}
+
+// Checks that remap sends the live nodes of before to a permutation of [0, after.order()),
+// erased nodes to null_id, and that values and edges moved along with the ids
+void check_remap(const graph_type& before, const graph_type& after, const graph_type::id_map& remap)
+{
+    const graph_type::id_map identity;
+    std::vector<bool> taken(after.capacity(), false);
+
+    assert(remap.size() == before.capacity());
+    assert(after.capacity() == before.order() && after.order() == before.order());
+
+    for (size_t node = 0; node < before.capacity(); ++node)
+    {
+        if (!before.is_valid(node))
+        {
+            assert(remap[node] == graph_type::null_id);
+            continue;
+        }
+
+        size_t dst = remap[node];
+
+        assert(dst < after.capacity() && !taken[dst] && after.is_valid(dst));
+        taken[dst] = true;
+
+        assert(after[dst] == before[node]);
+        assert(mapped_edges(before, node, true, remap) == mapped_edges(after, dst, true, identity));
+        assert(mapped_edges(before, node, false, remap) == mapped_edges(after, dst, false, identity));
+    }
+}
+
+void compact_keeps_values_and_edges()
+{
+    std::mt19937 rng { 1 };
+
+    for (size_t n : { 1, 20, 300 })
+    {
+        for (size_t erased : { size_t(0), n / 3, n })
+        {
+            graph_type G = make_graph(rng, n, 3 * n);
+            erase_some(rng, G, erased);
+
+            graph_type before = G;
+            graph_type::id_map remap = G.compact();
+
+            check_remap(before, G, remap);
+
+            // Ids are dense, so new nodes come right after the live ones
+            assert(G.insert(7) == n - erased);
+        }
+    }
+}
+
+template <typename graph_t>
+void check_counts(const graph_t& G, size_t order)
+{
+    size_t outs = 0;
+    size_t ins = 0;
+    size_t live = 0;
+
+    for (size_t node = 0; node < G.capacity(); ++node)
+    {
+        outs += G.out(node).size();
+        ins += G.in(node).size();
+        live += G.is_valid(node) ? 1 : 0;
+    }
+
+    assert(G.size() == outs && G.size() == ins);
+    assert(G.order() == live && G.order() == order);
+    assert(G.empty() == (order == 0));
+}
+
+template <typename graph_t>
+void edge_count_follows_changes()
+{
+    std::mt19937 rng { 2 };
+    const size_t n = 200;
+
+    graph_t G;
+    std::vector<int> values(n, 3);
+
+    assert(G.insert(values.begin(), values.end()) == 0);
+    check_counts(G, n);
+
+    // Pairs and tuples, with self loops and parallel edges
+    std::uniform_int_distribution<size_t> node(0, n - 1);
+    std::vector<std::pair<size_t, size_t>> pairs;
+    std::vector<std::tuple<size_t, size_t, long>> tuples;
+
+    for (size_t k = 0; k < 2 * n; ++k)
+    {
+        pairs.emplace_back(node(rng), node(rng));
+        tuples.emplace_back(node(rng), node(rng), 2);
+    }
+
+    pairs.emplace_back(5, 5);
+    pairs.emplace_back(5, 6);
+    pairs.emplace_back(5, 6);
+
+    G.insert_edges(pairs.begin(), pairs.end());
+    check_counts(G, n);
+
+    G.insert_edges(tuples.begin(), tuples.end());
+    G.edge(7, 7, 1);
+    check_counts(G, n);
+
+    assert(G.insert(values.begin(), values.begin() + 10) == n);
+    check_counts(G, n + 10);
+
+    G.erase(5, 6);
+    G.erase(7, 7);
+    G.erase(n + 3, 0);
+    check_counts(G, n + 10);
+
+    G.erase(5);
+    G.erase(std::vector<size_t> { 1, 2, 3, n + 1 });
+    check_counts(G, n + 5);
+
+    G.compact();
+    check_counts(G, n + 5);
+
+    G.erase(std::vector<size_t> {});
+    check_counts(G, n + 5);
+}
+
+void erased_ids_are_recycled()
+{
+    graph_type G;
+    std::vector<int> values(200, 1);
+    G.insert(values.begin(), values.end());
+
+    for (size_t node = 0; node + 1 < 200; ++node)
+    {
+        G.edge(node, node + 1, 1);
+    }
+
+    // Ids on both sides of the 64 bits words of the live bitmap
+    const std::vector<size_t> erased { 0, 63, 64, 127, 128, 199 };
+
+    G.erase(erased);
+
+    // Erasing twice must not hand the same id out twice
+    G.erase(64);
+    G.erase(std::vector<size_t> { 63 });
+
+    for (size_t node : erased)
+    {
+        assert(!G.is_valid(node));
+    }
+
+    assert(G.order() == 194 && G.capacity() == 200);
+    assert(!G.is_valid(200) && !G.is_valid(graph_type::null_id));
+
+    std::vector<size_t> reused;
+
+    for (size_t k = 0; k < erased.size(); ++k)
+    {
+        size_t node = G.insert(static_cast<int>(k) + 5);
+
+        assert(node < 200 && G.is_valid(node));
+        assert(G[node] == static_cast<int>(k) + 5);
+        assert(G.out(node).empty() && G.in(node).empty());
+
+        reused.push_back(node);
+    }
+
+    std::sort(reused.begin(), reused.end());
+    assert(reused == erased);
+    assert(G.order() == 200 && G.capacity() == 200);
+
+    // No free ids left: new nodes come after the last one, and bulk inserts always append
+    assert(G.insert(9) == 200);
+    G.erase(10);
+    assert(G.insert(values.begin(), values.begin() + 3) == 201);
+    assert(G.insert(9) == 10);
+    assert(G.order() == 204 && G.capacity() == 204);
+
+    size_t live = 0;
+
+    for (auto it = G.nodes_begin(); it != G.nodes_end(); ++it)
+    {
+        assert(G.is_valid(*it));
+        live++;
+    }
+
+    assert(live == G.order());
+}
+
+void reorder_keeps_values_and_edges()
+{
+    std::mt19937 rng { 3 };
+
+    const estd::node_order strategies[] = {
+        estd::node_order::reverse_cuthill_mckee,
+        estd::node_order::degree,
+        estd::node_order::bfs,
+        estd::node_order::dfs
+    };
+
+    for (size_t n : { 1, 20, 300 })
+    {
+        for (estd::node_order strategy : strategies)
+        {
+            // Sparse, so that some nodes are isolated and visits have to restart
+            graph_type G = make_graph(rng, n, n);
+            erase_some(rng, G, n / 4);
+
+            graph_type before = G;
+            graph_type::id_map order = estd::node_ordering(G, strategy);
+            graph_type::id_map remap = estd::reorder(G, strategy);
+
+            assert(order == remap);
+            check_remap(before, G, remap);
+
+            if (strategy == estd::node_order::degree)
+            {
+                for (size_t node = 1; node < G.capacity(); ++node)
+                {
+                    assert(G.degree(node - 1) >= G.degree(node));
+                }
+            }
+        }
+
+        // Any permutation of the live nodes, given to relabel directly
+        graph_type G = make_graph(rng, n, 2 * n);
+        erase_some(rng, G, n / 4);
+
+        std::vector<size_t> targets(G.order());
+
+        for (size_t k = 0; k < targets.size(); ++k)
+        {
+            targets[k] = k;
+        }
+
+        std::shuffle(targets.begin(), targets.end(), rng);
+
+        graph_type::id_map remap(G.capacity(), graph_type::null_id);
+        size_t next = 0;
+
+        for (size_t node = 0; node < G.capacity(); ++node)
+        {
+            remap[node] = G.is_valid(node) ? targets[next++] : graph_type::null_id;
+        }
+
+        graph_type before = G;
+        G.relabel(remap);
+        check_remap(before, G, remap);
+    }
+}
+
+void unweighted_graphs_store_no_weights()
+{
+    estd::unweighted_digraph<int> U;
+    std::vector<int> values(6);
+    U.insert(values.begin(), values.end());
+
+    // 0 -> 1 -> 2 -> 3 is longer in hops than 0 -> 4 -> 3, whatever weights edge is given
+    U.edge(0, 1, 1);
+    U.edge(1, 2, 1);
+    U.edge(2, 3, 1);
+    U.edge(0, 4, 50);
+    U.edge(4, 3, -7);
+
+    std::vector<std::tuple<size_t, size_t, long>> edges { std::make_tuple(3, 5, 9) };
+    U.insert_edges(edges.begin(), edges.end());
+
+    assert(!U.is_weighted() && !U.has_negative_weights());
+    assert(U.size() == 6);
+    assert(U.weight(0, 4) == 1 && U.weight(4, 3) == 1 && U.weight(3, 5) == 1);
+    assert(U.out_edges(0).weights() == nullptr && U.in_edges(3).weights() == nullptr);
+    assert(U.memory_usage().weights == 0);
+
+    for (size_t node = 0; node < U.capacity(); ++node)
+    {
+        for (auto e : U.out_edges(node))
+        {
+            assert(e.second == 1);
+        }
+    }
+
+    // Distances are hops, found by BFS: the weights given to edge, the negative one too, are dropped
+    estd::unweighted_digraph<int>::path_result p = U.shortest_path(0, 3);
+
+    assert(p.second == 2);
+    assert((p.first == std::vector<size_t> { 0, 4, 3 }));
+    assert(U.shortest_path(0, 5).second == 3);
+    assert(U.shortest_paths(0)->distance_to(3) == estd::bfs_distance(U, 0).distance_to(3));
+
+    // The same edges with weights stored take the cheaper, longer way
+    graph_type W;
+    W.insert(values.begin(), values.end());
+    W.edge(0, 1, 1);
+    W.edge(1, 2, 1);
+    W.edge(2, 3, 1);
+    W.edge(0, 4, 50);
+
+    assert(W.is_weighted() && W.shortest_path(0, 3).second == 3);
+}
+
+} // namespace
+
+int main()
+{
+    compact_keeps_values_and_edges();
+    edge_count_follows_changes<graph_type>();
+    edge_count_follows_changes<estd::weighted_undirected_graph<int, long>>();
+    erased_ids_are_recycled();
+    reorder_keeps_values_and_edges();
+    unweighted_graphs_store_no_weights();
+
+    std::printf("graph_test: ok\n");
+
+    return 0;
+}
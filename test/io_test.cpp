@@ -0,0 +1,317 @@
+// MIT License
+
+// graph - http://www.github/ilariom/graph
+// Copyright (c) 2020 - Ilario Mangano
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Tests of the binary format and the text readers. Build and run from the repository root:
+//
+//     g++ -std=c++11 -pthread -I. test/io_test.cpp -o io_test && ./io_test
+
+#undef NDEBUG
+
+#include "graph_io.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+template <typename key_type>
+bool read_edges(const std::string& text, std::unordered_map<key_type, size_t>& ids)
+{
+    std::istringstream in { text };
+    estd::digraph<int> G;
+
+    return estd::load_edge_list(in, G, ids, 1);
+}
+
+template <typename key_type>
+bool read_edges(const std::string& text)
+{
+    std::unordered_map<key_type, size_t> ids;
+    return read_edges(text, ids);
+}
+
+template <typename value_type>
+bool read_value(const std::string& text, value_type& value)
+{
+    std::istringstream in { text };
+    estd::graph<value_type> G;
+    std::unordered_map<int, size_t> ids;
+
+    if (!estd::load_node_values(in, G, ids))
+    {
+        return false;
+    }
+
+    value = G[ids.at(1)];
+    return true;
+}
+
+void integral_keys_out_of_range()
+{
+    std::unordered_map<int64_t, size_t> ids;
+
+    assert(read_edges("9223372036854775807 -9223372036854775808\n", ids));
+    assert(ids.count(std::numeric_limits<int64_t>::max()) == 1);
+    assert(ids.count(std::numeric_limits<int64_t>::min()) == 1);
+
+    assert(!read_edges<int64_t>("9223372036854775808 1\n"));
+    assert(!read_edges<int64_t>("1 -9223372036854775809\n"));
+    assert(!read_edges<int64_t>("1 99999999999999999999999\n"));
+
+    assert(read_edges<uint64_t>("18446744073709551615 0\n"));
+    assert(!read_edges<uint64_t>("18446744073709551616 0\n"));
+    assert(!read_edges<uint64_t>("-1 0\n"));
+
+    assert(read_edges<int32_t>("2147483647 -2147483648\n"));
+    assert(!read_edges<int32_t>("2147483648 0\n"));
+    assert(!read_edges<int32_t>("0 -2147483649\n"));
+}
+
+void integral_values_out_of_range()
+{
+    short s = 0;
+
+    assert(read_value("1 32767\n", s) && s == 32767);
+    assert(read_value("1 -32768\n", s) && s == -32768);
+    assert(!read_value("1 32768\n", s));
+    assert(!read_value("1 -32769\n", s));
+
+    unsigned char c = 0;
+
+    assert(read_value("1 255\n", c) && c == 255);
+    assert(!read_value("1 256\n", c));
+}
+
+using graph_type = estd::weighted_digraph<int, long>;
+
+graph_type make_graph()
+{
+    graph_type G;
+
+    for (int k = 0; k < 100; ++k)
+    {
+        G.insert(k * 3);
+    }
+
+    for (size_t node = 0; node < 100; ++node)
+    {
+        G.edge(node, (node * 7 + 1) % 100, static_cast<long>(node) - 20);
+        G.edge(node, (node * 13 + 5) % 100, static_cast<long>(node));
+    }
+
+    G.erase(42);
+    G.erase(57);
+
+    return G;
+}
+
+template <typename graph_a, typename graph_b>
+void assert_same_graph(const graph_a& G, const graph_b& H)
+{
+    assert(G.capacity() == H.capacity());
+    assert(G.order() == H.order());
+    assert(G.size() == H.size());
+    assert(G.has_negative_weights() == H.has_negative_weights());
+
+    for (size_t node = 0; node < G.capacity(); ++node)
+    {
+        assert(G.is_valid(node) == H.is_valid(node));
+
+        if (!G.is_valid(node))
+        {
+            continue;
+        }
+
+        assert(G[node] == H[node]);
+        assert(G.out_edges(node).size() == H.out_edges(node).size());
+        assert(G.in_edges(node).size() == H.in_edges(node).size());
+
+        for (size_t idx = 0; idx < G.out_edges(node).size(); ++idx)
+        {
+            assert(G.out_edges(node)[idx] == H.out_edges(node)[idx]);
+        }
+
+        for (size_t idx = 0; idx < G.in_edges(node).size(); ++idx)
+        {
+            assert(G.in_edges(node)[idx] == H.in_edges(node)[idx]);
+        }
+    }
+}
+
+bool load_bytes(const std::string& bytes, graph_type& G)
+{
+    std::istringstream in { bytes };
+    return estd::load(in, G);
+}
+
+bool map_bytes(const std::string& bytes, estd::csr_graph<int, long>& C)
+{
+    const char* filename = "io_test.bin";
+
+    {
+        std::ofstream out { filename, std::ios::binary };
+        out.write(bytes.data(), bytes.size());
+    }
+
+    bool ok = estd::map_graph(filename, C);
+    std::remove(filename);
+
+    return ok;
+}
+
+// Loading over a graph that isn't empty checks that a failure leaves it empty
+void assert_rejected(const std::string& bytes)
+{
+    graph_type G = make_graph();
+    estd::csr_graph<int, long> C;
+
+    assert(!load_bytes(bytes, G));
+    assert(G.empty() && G.capacity() == 0 && G.size() == 0);
+    assert(!map_bytes(bytes, C));
+}
+
+void binary_round_trip()
+{
+    graph_type G = make_graph();
+    std::ostringstream out;
+
+    assert(estd::save(G, out));
+
+    const std::string bytes = out.str();
+    graph_type loaded;
+    estd::csr_graph<int, long> mapped;
+
+    assert(load_bytes(bytes, loaded));
+    assert_same_graph(G, loaded);
+
+    assert(map_bytes(bytes, mapped));
+    assert_same_graph(G, mapped);
+
+    // The mapping outlives the file name, and copies of the view share it
+    estd::csr_graph<int, long> copy = mapped;
+    mapped = estd::csr_graph<int, long> {};
+    assert_same_graph(G, copy);
+}
+
+void binary_rejects_bad_files()
+{
+    graph_type G = make_graph();
+    std::ostringstream out;
+
+    assert(estd::save(G, out));
+
+    const std::string bytes = out.str();
+    estd::io::header h;
+    std::memcpy(&h, bytes.data(), sizeof(h));
+    estd::io::layout L { h };
+
+    assert(L.total == bytes.size());
+
+    // Cut off in the header, at the start of every array and one byte short of the end
+    for (size_t length : { size_t(0), sizeof(h) - 1, sizeof(h), L.targets, L.roffsets, L.objs, L.valid, bytes.size() - 1 })
+    {
+        assert_rejected(bytes.substr(0, length));
+    }
+
+    auto corrupt = [&bytes] (size_t pos, const void* data, size_t length) {
+        std::string copy = bytes;
+        std::memcpy(&copy[pos], data, length);
+        return copy;
+    };
+
+    const size_t huge = std::numeric_limits<size_t>::max() / 4;
+    const uint32_t wrong_size = sizeof(int) == 4 ? 8 : 4;
+
+    assert_rejected(corrupt(0, "xstdgrph", 8));
+    assert_rejected(corrupt(offsetof(estd::io::header, value_size), &wrong_size, 4));
+    assert_rejected(corrupt(offsetof(estd::io::header, capacity), &huge, sizeof(huge)));
+    assert_rejected(corrupt(offsetof(estd::io::header, size), &huge, sizeof(huge)));
+
+    // A target past the last node, and offsets that go back
+    assert_rejected(corrupt(L.targets, &huge, sizeof(huge)));
+    assert_rejected(corrupt(L.rtargets + sizeof(size_t), &huge, sizeof(huge)));
+    assert_rejected(corrupt(L.offsets + 10 * sizeof(size_t), &huge, sizeof(huge)));
+}
+
+void unweighted_files()
+{
+    std::ostringstream weighted;
+    std::ostringstream unit;
+    graph_type G;
+    estd::digraph<int> D;
+
+    for (int k = 0; k < 3; ++k)
+    {
+        G.insert(k);
+        D.insert(k);
+    }
+
+    G.edge(0, 1, 4);
+    D.edge(0, 1);
+    D.edge(1, 2);
+
+    assert(estd::save(G, weighted) && estd::save(D, unit));
+
+    // An unweighted graph would lose the weights of the first file
+    estd::unweighted_digraph<int> U;
+    std::istringstream in { weighted.str() };
+    assert(!estd::load(in, U));
+    assert(U.empty());
+
+    std::istringstream unit_in { unit.str() };
+    assert(estd::load(unit_in, U));
+    assert(!U.is_weighted() && U.size() == 2 && U.weight(1, 2) == 1);
+
+    std::ostringstream back;
+    estd::digraph<int> D2;
+    assert(estd::save(U, back));
+
+    std::istringstream back_in { back.str() };
+    assert(estd::load(back_in, D2));
+    assert(!D2.is_weighted() && D2.size() == 2 && D2.out(0).front() == 1);
+}
+
+} // namespace
+
+int main()
+{
+    binary_round_trip();
+    binary_rejects_bad_files();
+    unweighted_files();
+    integral_keys_out_of_range();
+    integral_values_out_of_range();
+
+    std::printf("io_test: ok\n");
+
+    return 0;
+}
@@ -0,0 +1,291 @@
+// MIT License
+
+// graph - http://www.github/ilariom/graph
+// Copyright (c) 2020 - Ilario Mangano
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Tests of the parallel builders and algorithms. Build and run from the repository root:
+//
+//     g++ -std=c++11 -pthread -I. test/parallel_test.cpp -o parallel_test && ./parallel_test
+//
+// Adding -fsanitize=thread checks the concurrent parts for data races.
+
+#undef NDEBUG
+
+#include "parallel.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+using graph_type = estd::weighted_digraph<int, long>;
+using edge_list = std::vector<std::tuple<size_t, size_t, long>>;
+
+edge_list random_edges(std::mt19937& rng, size_t n, size_t m, long max_weight)
+{
+    std::uniform_int_distribution<size_t> node(0, n - 1);
+    std::uniform_int_distribution<long> weight(0, max_weight);
+    edge_list edges;
+
+    for (size_t k = 0; k < m; ++k)
+    {
+        edges.emplace_back(node(rng), node(rng), weight(rng));
+    }
+
+    return edges;
+}
+
+graph_type make_graph(size_t n)
+{
+    graph_type G;
+    std::vector<int> values(n);
+    G.insert(values.begin(), values.end());
+
+    return G;
+}
+
+// Edges of a node as sorted (adjacent node, weight) pairs, as the builder
+// only keeps the order of edges added by the same thread
+std::vector<std::pair<size_t, long>> sorted_edges(const graph_type::edge_range& edges)
+{
+    std::vector<std::pair<size_t, long>> sorted;
+
+    for (auto e : edges)
+    {
+        sorted.push_back(e);
+    }
+
+    std::sort(sorted.begin(), sorted.end());
+
+    return sorted;
+}
+
+void builder_matches_insert_edges()
+{
+    const size_t n = 500;
+    const unsigned producers = 8;
+
+    std::mt19937 rng { 1 };
+    edge_list edges = random_edges(rng, n, 20000, 9);
+
+    graph_type expected = make_graph(n);
+    expected.insert_edges(edges.begin(), edges.end());
+
+    for (unsigned threads : { 1u, 4u })
+    {
+        estd::graph_builder<int, long> builder { 3 };
+        std::vector<std::thread> workers;
+
+        for (unsigned t = 0; t < producers; ++t)
+        {
+            workers.emplace_back([&builder, &edges, t] {
+                for (size_t k = t; k < edges.size(); k += producers)
+                {
+                    builder.add_edge(std::get<0>(edges[k]), std::get<1>(edges[k]), std::get<2>(edges[k]));
+                }
+            });
+        }
+
+        for (std::thread& w : workers)
+        {
+            w.join();
+        }
+
+        assert(builder.size() == edges.size());
+
+        graph_type G = make_graph(n);
+        builder.build(G, threads);
+
+        assert(builder.size() == 0);
+        assert(G.size() == expected.size());
+
+        for (size_t node = 0; node < n; ++node)
+        {
+            assert(sorted_edges(G.out_edges(node)) == sorted_edges(expected.out_edges(node)));
+            assert(sorted_edges(G.in_edges(node)) == sorted_edges(expected.in_edges(node)));
+        }
+    }
+}
+
+void parallel_bfs_matches_bfs()
+{
+    std::mt19937 rng { 3 };
+
+    // Sparse graphs are disconnected and keep long top-down phases, dense
+    // ones switch to bottom-up steps once the frontier grows
+    for (size_t n : { 1, 2, 100, 3000 })
+    {
+        for (size_t degree : { 1, 3, 20 })
+        {
+            graph_type G = make_graph(n);
+            std::uniform_int_distribution<size_t> node(0, n - 1);
+            edge_list edges = random_edges(rng, n, n * degree, 1);
+            G.insert_edges(edges.begin(), edges.end());
+
+            for (size_t k = 0; k < n / 20; ++k)
+            {
+                size_t erased = node(rng);
+
+                if (erased != 0)
+                {
+                    G.erase(erased);
+                }
+            }
+
+            graph_type::path expected = estd::bfs_distance(G, 0);
+
+            for (unsigned threads : { 1u, 4u })
+            {
+                graph_type::path d = estd::parallel_bfs_distance(G, 0, threads);
+                graph_type::path par = estd::bfs_distance(G, 0, estd::execution::parallel_policy { threads });
+
+                for (size_t k = 0; k < n; ++k)
+                {
+                    assert(d.distance_to(k) == expected.distance_to(k));
+                    assert(par.distance_to(k) == expected.distance_to(k));
+
+                    if (G.is_valid(k) && expected.distance_to(k) != std::numeric_limits<long>::max())
+                    {
+                        std::vector<size_t> path = d.path_to(k);
+                        assert(path.size() == static_cast<size_t>(expected.distance_to(k)) + 1);
+                        assert(path.front() == 0 && path.back() == k);
+
+                        for (size_t idx = 1; idx < path.size(); ++idx)
+                        {
+                            const auto& out = G.out(path[idx - 1]);
+                            assert(std::find(out.begin(), out.end(), path[idx]) != out.end());
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void delta_stepping_matches_dijkstra()
+{
+    const size_t n = 400;
+
+    std::mt19937 rng { 2 };
+
+    for (long max_weight : { 1L, 10L, 1000L, 100000L })
+    {
+        graph_type G = make_graph(n);
+        edge_list edges = random_edges(rng, n, 3 * n, max_weight);
+        G.insert_edges(edges.begin(), edges.end());
+
+        graph_type::path expected = estd::dijkstra(G, 0);
+        long farthest = 0;
+
+        for (size_t node = 0; node < n; ++node)
+        {
+            long d = expected.distance_to(node);
+            farthest = d != std::numeric_limits<long>::max() ? std::max(farthest, d) : farthest;
+        }
+
+        // 0 picks the average weight. With delta = max_weight / 100 the cyclic array keeps
+        // about 100 buckets, fewer than the distances span, so bucket indices wrap around
+        for (long delta : { 0L, max_weight / 100 + 1, max_weight / 3 + 1, max_weight })
+        {
+            assert(max_weight < 1000 || delta != max_weight / 100 + 1 || farthest / delta >= max_weight / delta + 2);
+
+            for (unsigned threads : { 1u, 3u, 8u })
+            {
+                graph_type::path d = estd::delta_stepping(G, 0, delta, threads);
+
+                for (size_t node = 0; node < n; ++node)
+                {
+                    assert(d.distance_to(node) == expected.distance_to(node));
+                }
+            }
+        }
+    }
+}
+
+// Edges much heavier than delta used to need a bucket per delta up to the heaviest one
+void delta_stepping_with_heavy_edges()
+{
+    const size_t n = 1000;
+
+    graph_type G = make_graph(n);
+
+    for (size_t node = 0; node + 1 < n; ++node)
+    {
+        G.edge(node, node + 1, node == n / 2 ? 4000000000L : 1L);
+    }
+
+    G.edge(0, n - 1, 4000000001L + static_cast<long>(n));
+
+    graph_type::path expected = estd::dijkstra(G, 0);
+
+    for (unsigned threads : { 1u, 4u })
+    {
+        graph_type::path d = estd::delta_stepping(G, 0, 1L, threads);
+        graph_type::path b = estd::bellman_ford(G, 0, estd::execution::parallel_policy { threads, 1.0 });
+
+        for (size_t node = 0; node < n; ++node)
+        {
+            assert(d.distance_to(node) == expected.distance_to(node));
+            assert(b.distance_to(node) == expected.distance_to(node));
+        }
+    }
+
+    // A delta so small that the distances over it don't fit a size_t
+    estd::weighted_digraph<int, double> W;
+    std::vector<int> values(n);
+    W.insert(values.begin(), values.end());
+
+    for (size_t node = 0; node + 1 < n; ++node)
+    {
+        W.edge(node, node + 1, node % 10 == 0 ? 1e12 : 0.5);
+    }
+
+    auto expected_w = estd::dijkstra(W, 0);
+    auto tiny = estd::delta_stepping(W, 0, 1e-300, 4);
+
+    for (size_t node = 0; node < n; ++node)
+    {
+        assert(tiny.distance_to(node) == expected_w.distance_to(node));
+    }
+}
+
+} // namespace
+
+int main()
+{
+    builder_matches_insert_edges();
+    parallel_bfs_matches_bfs();
+    delta_stepping_matches_dijkstra();
+    delta_stepping_with_heavy_edges();
+
+    std::printf("parallel_test: ok\n");
+
+    return 0;
+}
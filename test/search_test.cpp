@@ -0,0 +1,381 @@
+// MIT License
+
+// graph - http://www.github/ilariom/graph
+// Copyright (c) 2020 - Ilario Mangano
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Tests of the search iterators. Build and run from the repository root:
+//
+//     g++ -std=c++11 -pthread -I. test/search_test.cpp -o search_test && ./search_test
+
+#undef NDEBUG
+
+#include "graph.h"
+#include "csr_graph.h"
+#include "concurrent_graph.h"
+
+#include <cassert>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+
+using graph_type = estd::weighted_digraph<int, long>;
+
+// 0 -> 1 -> 3 is cheaper than 0 -> 2 -> 3, and 4 is only reachable from 3
+graph_type make_graph()
+{
+    graph_type G;
+
+    for (int k = 0; k < 5; ++k)
+    {
+        G.insert(k);
+    }
+
+    G.edge(0, 1, 1);
+    G.edge(0, 2, 5);
+    G.edge(1, 3, 1);
+    G.edge(2, 3, 1);
+    G.edge(3, 4, 1);
+
+    return G;
+}
+
+template <typename G>
+void astar_with_lambda_heuristic(const G& g)
+{
+    const size_t goal = 3;
+    auto astar = estd::search_algorithm::make_astar([] (size_t node) { return node == 3 ? 0.0 : 1.0; }, goal);
+
+    std::vector<size_t> visit;
+
+    for (auto it = g.begin(0, astar); it != g.end(astar); ++it)
+    {
+        visit.push_back(*it);
+    }
+
+    assert((visit == std::vector<size_t> { 0, 1, 3 }));
+
+    visit.clear();
+
+    for (auto it = g.rbegin(4, astar); it != g.rend(astar); ++it)
+    {
+        visit.push_back(*it);
+    }
+
+    assert(visit.front() == 4 && visit.back() == 3);
+}
+
+// Checks that result is a path from source to target made of edges of G, whose
+// weights add up to the expected distance, or that both say target is unreachable
+template <typename graph_t>
+void check_path(
+    const graph_t& G, 
+    const typename graph_t::path_result& result, 
+    size_t source, 
+    size_t target, 
+    typename graph_t::weight_type expected
+)
+{
+    using weight_type = typename graph_t::weight_type;
+
+    assert(result.second == expected);
+
+    if (expected == std::numeric_limits<weight_type>::max())
+    {
+        assert(result.first.empty());
+        return;
+    }
+
+    const std::vector<size_t>& p = result.first;
+    weight_type total = 0;
+
+    assert(!p.empty() && p.front() == source && p.back() == target);
+
+    for (size_t idx = 1; idx < p.size(); ++idx)
+    {
+        weight_type best = std::numeric_limits<weight_type>::max();
+
+        for (auto e : G.out_edges(p[idx - 1]))
+        {
+            best = e.first == p[idx] && e.second < best ? e.second : best;
+        }
+
+        assert(best != std::numeric_limits<weight_type>::max());
+        total += best;
+    }
+
+    assert(total == expected);
+}
+
+template <typename graph_t>
+graph_t random_graph(std::mt19937& rng, size_t n, size_t m, long min_weight, long max_weight)
+{
+    graph_t G;
+    std::uniform_int_distribution<size_t> node(0, n - 1);
+    std::uniform_int_distribution<long> weight(min_weight, max_weight);
+
+    for (size_t k = 0; k < n; ++k)
+    {
+        G.insert(static_cast<int>(k));
+    }
+
+    for (size_t k = 0; k < m; ++k)
+    {
+        G.edge(node(rng), node(rng), weight(rng));
+    }
+
+    for (size_t k = 0; k < n / 10; ++k)
+    {
+        G.erase(node(rng));
+    }
+
+    return G;
+}
+
+void bidirectional_matches_single_source()
+{
+    std::mt19937 rng { 1 };
+
+    for (size_t n : { 1, 10, 200 })
+    {
+        // Sparse graphs leave many pairs unreachable
+        for (size_t m : { n, 4 * n })
+        {
+            graph_type W = random_graph<graph_type>(rng, n, m, 0, 9);
+            estd::digraph<int> U = random_graph<estd::digraph<int>>(rng, n, m, 1, 1);
+
+            assert(W.is_weighted() && !U.is_weighted());
+
+            for (size_t source = 0; source < n; ++source)
+            {
+                graph_type::path dw = estd::dijkstra(W, source);
+                estd::digraph<int>::path du = estd::bfs_distance(U, source);
+
+                for (size_t target = 0; target < n; ++target)
+                {
+                    long ew = W.is_valid(source) && W.is_valid(target) ? dw.distance_to(target) : std::numeric_limits<long>::max();
+                    ssize_t eu = U.is_valid(source) && U.is_valid(target) ? du.distance_to(target) : std::numeric_limits<ssize_t>::max();
+
+                    check_path(W, estd::bidirectional_dijkstra(W, source, target), source, target, ew);
+                    check_path(U, estd::bidirectional_bfs(U, source, target), source, target, eu);
+
+                    // Once by bidirectional search, then from the cached tree of source
+                    check_path(W, W.shortest_path(source, target), source, target, ew);
+                    check_path(U, U.shortest_path(source, target), source, target, eu);
+                }
+            }
+        }
+    }
+}
+
+void bidirectional_edge_cases()
+{
+    graph_type G = make_graph();
+    const long inf = std::numeric_limits<long>::max();
+
+    check_path(G, estd::bidirectional_dijkstra(G, 2, 2), 2, 2, 0);
+    check_path(G, G.shortest_path(2, 2), 2, 2, 0);
+    check_path(G, G.shortest_path(0, 4), 0, 4, 3);
+
+    // Nothing leads back to 0, and 4 leads nowhere
+    check_path(G, estd::bidirectional_dijkstra(G, 4, 0), 4, 0, inf);
+    check_path(G, G.shortest_path(3, 0), 3, 0, inf);
+
+    // Ids out of range
+    check_path(G, estd::bidirectional_dijkstra(G, 0, 5), 0, 5, inf);
+    check_path(G, estd::bidirectional_bfs(G, 7, 0), 7, 0, inf);
+    check_path(G, G.shortest_path(0, graph_type::null_id), 0, graph_type::null_id, inf);
+    check_path(G, G.shortest_path(graph_type::null_id, graph_type::null_id), graph_type::null_id, graph_type::null_id, inf);
+
+    // Erased endpoints, also as both ends of the query
+    G.erase(3);
+    check_path(G, estd::bidirectional_dijkstra(G, 0, 3), 0, 3, inf);
+    check_path(G, estd::bidirectional_bfs(G, 3, 4), 3, 4, inf);
+    check_path(G, estd::bidirectional_dijkstra(G, 3, 3), 3, 3, inf);
+    check_path(G, G.shortest_path(3, 3), 3, 3, inf);
+    check_path(G, G.shortest_path(0, 4), 0, 4, inf);
+    check_path(G, G.shortest_path(0, 2), 0, 2, 5);
+}
+
+// Every query from every node, answered by G and its caches, matches a fresh solve
+void check_queries(const graph_type& G)
+{
+    for (size_t source = 0; source < G.capacity(); ++source)
+    {
+        if (!G.is_valid(source))
+        {
+            continue;
+        }
+
+        graph_type::path expected = estd::sssp::solve(G, source);
+        auto start = G.begin<estd::search_algorithm::bfs>(source);
+        graph_type::path from_start = start > G;
+
+        assert(G.shortest_paths(source)->root() == source);
+
+        for (size_t target = 0; target < G.capacity(); ++target)
+        {
+            if (!G.is_valid(target))
+            {
+                continue;
+            }
+
+            auto goal = G.begin<estd::search_algorithm::bfs>(target);
+
+            assert(from_start.distance_to(target) == expected.distance_to(target));
+            assert(G.shortest_paths(source)->distance_to(target) == expected.distance_to(target));
+            assert(G.shortest_path(source, target).second == expected.distance_to(target));
+            assert(goal - start == expected.distance_to(target));
+        }
+    }
+}
+
+void cached_paths_follow_changes()
+{
+    std::mt19937 rng { 2 };
+    graph_type G = random_graph<graph_type>(rng, 30, 60, 1, 9);
+
+    // Room for a tree per node, so that nothing is dropped for lack of space
+    G.set_path_cache_capacity(64);
+    check_queries(G);
+    check_queries(G);
+
+    std::uniform_int_distribution<size_t> pick(0, 29);
+
+    auto valid_node = [&] {
+        size_t node = pick(rng);
+
+        while (!G.is_valid(node))
+        {
+            node = pick(rng);
+        }
+
+        return node;
+    };
+
+    for (int round = 0; round < 3; ++round)
+    {
+        // Shortcuts
+        for (int k = 0; k < 3; ++k)
+        {
+            G.edge(valid_node(), valid_node(), 0);
+        }
+
+        check_queries(G);
+
+        size_t node = valid_node();
+
+        if (!G.out(node).empty())
+        {
+            G.erase(node, G.out(node).front());
+        }
+
+        check_queries(G);
+
+        G.erase(valid_node());
+        check_queries(G);
+
+        size_t added = G.insert(0);
+        G.edge(valid_node(), added, 1);
+        G.edge(added, valid_node(), 1);
+        check_queries(G);
+
+        std::vector<std::tuple<size_t, size_t, long>> edges;
+
+        for (int k = 0; k < 5; ++k)
+        {
+            edges.emplace_back(valid_node(), valid_node(), 1);
+        }
+
+        G.insert_edges(edges.begin(), edges.end());
+        check_queries(G);
+    }
+
+    // Ids move: trees cached for a root must not answer for the node now at that id
+    G.compact();
+    check_queries(G);
+
+    graph_type::id_map remap(G.capacity());
+
+    for (size_t node = 0; node < G.capacity(); ++node)
+    {
+        remap[node] = G.capacity() - 1 - node;
+    }
+
+    G.relabel(remap);
+    check_queries(G);
+}
+
+void path_cache_evicts_least_recently_used()
+{
+    graph_type G = make_graph();
+    G.set_path_cache_capacity(2);
+
+    auto p0 = G.shortest_paths(0);
+    auto p1 = G.shortest_paths(1);
+
+    assert(G.shortest_paths(0) == p0);
+    assert(G.shortest_paths(1) == p1);
+
+    // 0 has been used last, so 1 makes room for 2
+    assert(G.shortest_paths(0) == p0);
+    auto p2 = G.shortest_paths(2);
+
+    assert(G.shortest_paths(0) == p0);
+    assert(G.shortest_paths(2) == p2);
+    assert(G.shortest_paths(1) != p1);
+
+    // Shrinking keeps the most recently used trees
+    G.set_path_cache_capacity(1);
+    auto p1b = G.shortest_paths(1);
+    assert(G.shortest_paths(1) == p1b);
+    assert(G.shortest_paths(0) != p0);
+
+    G.set_path_cache_capacity(0);
+    assert(G.shortest_paths(3) != G.shortest_paths(3));
+    assert(*G.shortest_paths(0)->path_to(4).rbegin() == 4);
+}
+
+} // namespace
+
+int main()
+{
+    bidirectional_matches_single_source();
+    bidirectional_edge_cases();
+    cached_paths_follow_changes();
+    path_cache_evicts_least_recently_used();
+
+    graph_type G = make_graph();
+    estd::csr_graph<int, long> C(G);
+    estd::concurrent_graph<int, long> CG(G);
+
+    astar_with_lambda_heuristic(G);
+    astar_with_lambda_heuristic(C);
+    astar_with_lambda_heuristic(CG.read());
+
+    std::printf("search_test: ok\n");
+
+    return 0;
+}
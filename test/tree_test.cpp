@@ -0,0 +1,202 @@
+// MIT License
+
+// graph - http://www.github/ilariom/graph
+// Copyright (c) 2020 - Ilario Mangano
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+// Tests of tree_index. Build and run from the repository root:
+//
+//     g++ -std=c++11 -pthread -I. test/tree_test.cpp -o tree_test && ./tree_test
+
+#undef NDEBUG
+
+#include "graph.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+using tree_type = estd::tree<int>;
+
+const size_t null_id = tree_type::null_id;
+
+// Forest of n nodes with ids in random order, where each node hangs from a random
+// earlier one, or is a root with the given probability. long_chain favours the
+// latest nodes as parents, for deep trees.
+tree_type random_tree(std::mt19937& rng, size_t n, double roots, bool long_chain)
+{
+    tree_type G;
+    std::vector<size_t> ids(n);
+
+    for (size_t k = 0; k < n; ++k)
+    {
+        G.insert(static_cast<int>(k));
+    }
+
+    std::iota(ids.begin(), ids.end(), 0);
+    std::shuffle(ids.begin(), ids.end(), rng);
+
+    std::bernoulli_distribution is_root(roots);
+
+    for (size_t k = 1; k < n; ++k)
+    {
+        if (is_root(rng))
+        {
+            continue;
+        }
+
+        size_t lo = long_chain && k > 3 ? k - 3 : 0;
+        size_t parent = std::uniform_int_distribution<size_t>(lo, k - 1)(rng);
+        G.append(ids[parent], ids[k]);
+    }
+
+    return G;
+}
+
+size_t naive_depth(const tree_type& G, size_t node)
+{
+    size_t depth = 0;
+
+    for (; G.parent(node) != null_id; node = G.parent(node))
+    {
+        depth++;
+    }
+
+    return depth;
+}
+
+size_t naive_level_ancestor(const tree_type& G, size_t node, size_t k)
+{
+    for (; k > 0 && node != null_id; --k)
+    {
+        node = G.parent(node);
+    }
+
+    return node;
+}
+
+size_t naive_lca(const tree_type& G, size_t u, size_t v)
+{
+    size_t du = naive_depth(G, u);
+    size_t dv = naive_depth(G, v);
+
+    u = naive_level_ancestor(G, u, du - std::min(du, dv));
+    v = naive_level_ancestor(G, v, dv - std::min(du, dv));
+
+    while (u != v && u != null_id)
+    {
+        u = G.parent(u);
+        v = G.parent(v);
+    }
+
+    return u;
+}
+
+void check_queries(std::mt19937& rng, const tree_type& G)
+{
+    estd::tree_index I { G };
+    std::vector<size_t> nodes;
+
+    for (auto it = G.nodes_begin(); it != G.nodes_end(); ++it)
+    {
+        nodes.push_back(*it);
+    }
+
+    if (nodes.empty())
+    {
+        return;
+    }
+
+    for (size_t node : nodes)
+    {
+        size_t depth = naive_depth(G, node);
+
+        assert(I.depth(node) == depth);
+        assert(I.root(node) == naive_level_ancestor(G, node, depth));
+
+        for (size_t k = 0; k <= depth + 1; k += 1 + k / 4)
+        {
+            assert(I.level_ancestor(node, k) == naive_level_ancestor(G, node, k));
+        }
+
+        assert(I.level_ancestor(node, depth + 1) == null_id);
+    }
+
+    std::uniform_int_distribution<size_t> pick(0, nodes.size() - 1);
+    size_t queries = std::min<size_t>(nodes.size() * nodes.size(), 20000);
+
+    for (size_t q = 0; q < queries; ++q)
+    {
+        size_t u = nodes[pick(rng)];
+        size_t v = nodes[pick(rng)];
+        size_t expected = naive_lca(G, u, v);
+
+        assert(I.lca(u, v) == expected);
+        assert(I.lca(v, u) == expected);
+        assert(expected == null_id || (I.is_ancestor(expected, u) && I.is_ancestor(expected, v)));
+    }
+}
+
+void index_matches_parent_walk()
+{
+    std::mt19937 rng { 1 };
+
+    // Sizes around the 64 nodes blocks of the range minimum, and a few not multiple of it
+    for (size_t n : { 1, 2, 63, 64, 65, 127, 128, 129, 200, 1000, 4097 })
+    {
+        for (double roots : { 0.0, 0.05 })
+        {
+            for (bool long_chain : { false, true })
+            {
+                tree_type G = random_tree(rng, n, roots, long_chain);
+                check_queries(rng, G);
+
+                // Erased nodes leave holes in the ids, and make roots of their children
+                std::vector<size_t> erased;
+
+                for (size_t node = 0; node < n; node += 7)
+                {
+                    erased.push_back(node);
+                }
+
+                G.erase(erased);
+                check_queries(rng, G);
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main()
+{
+    index_matches_parent_walk();
+
+    std::printf("tree_test: ok\n");
+
+    return 0;
+}
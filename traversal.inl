@@ -0,0 +1,142 @@
+// Dense set of node ids. Clearing it only bumps an epoch, so the same
+// storage can be reused by any number of visits without touching the heap.
+class visited_set
+{
+public:
+    void reserve(size_t capacity)
+    {
+        if (stamps_.size() < capacity)
+        {
+            stamps_.resize(capacity, 0);
+        }
+    }
+
+    void clear()
+    {
+        if (++epoch_ == 0)
+        {
+            std::fill(stamps_.begin(), stamps_.end(), 0);
+            epoch_ = 1;
+        }
+    }
+
+    bool insert(size_t node)
+    {
+        bool inserted = stamps_[node] != epoch_;
+        stamps_[node] = epoch_;
+        return inserted;
+    }
+
+    bool contains(size_t node) const { return stamps_[node] == epoch_; }
+    size_t capacity() const { return stamps_.size(); }
+
+private:
+    std::vector<uint32_t> stamps_;
+    uint32_t epoch_ = 1;
+};
+
+// Caller owned storage for a visit. Passing the same workspace to many
+// begin<>() calls lets them reuse the visited set and the frontier, so that
+// once warmed up, visits don't allocate at all.
+// A workspace must be used by one search_iterator at a time.
+template <typename container_type>
+struct traversal_workspace
+{
+    explicit traversal_workspace(const container_type& configured = container_type())
+        : frontier(configured)
+    { }
+
+    container_type frontier;
+    visited_set visited;
+};
+
+// Hooks called by search_iterator, bfs_distance and bellman_ford while they run.
+// This one does nothing and is the default, so uninstrumented code pays nothing.
+struct null_stats
+{
+    void expand() { }
+    void scan(size_t) { }
+    void lookup(size_t = 1) { }
+    void frontier(size_t) { }
+    void relax() { }
+    void pass() { }
+    void begin_phase(const char*) { }
+    void end_phase() { }
+};
+
+// Tells apart stats objects from other arguments, like execution policies
+template <typename stats_type, typename = void>
+struct is_stats : std::false_type
+{ };
+
+template <typename stats_type>
+struct is_stats<stats_type, decltype(std::declval<stats_type&>().relax(), std::declval<stats_type&>().end_phase())> : std::true_type
+{ };
+
+// Counts the work done by an algorithm, and optionally the time spent in each of its phases.
+// Counters add up over runs until reset() is called.
+struct traversal_stats
+{
+    using clock_type = std::chrono::steady_clock;
+
+    explicit traversal_stats(bool time_phases = false)
+        : timings(time_phases)
+    { }
+
+    void expand() { nodes_expanded++; }
+    void scan(size_t edges) { edges_scanned += edges; }
+    void lookup(size_t n = 1) { visited_lookups += n; }
+    void frontier(size_t size) { peak_frontier = std::max(peak_frontier, size); }
+    void relax() { relaxations++; }
+    void pass() { passes++; }
+
+    void begin_phase(const char* name)
+    {
+        if (timings)
+        {
+            phase_ = name;
+            phase_start_ = clock_type::now();
+        }
+    }
+
+    void end_phase()
+    {
+        if (!timings || phase_ == nullptr)
+        {
+            return;
+        }
+
+        double seconds = std::chrono::duration<double>(clock_type::now() - phase_start_).count();
+        auto it = std::find_if(phases.begin(), phases.end(), [this] (const std::pair<const char*, double>& p) { 
+            return std::strcmp(p.first, phase_) == 0; 
+        });
+
+        if (it == phases.end())
+        {
+            phases.emplace_back(phase_, seconds);
+        }
+        else
+        {
+            it->second += seconds;
+        }
+
+        phase_ = nullptr;
+    }
+
+    void reset() { *this = traversal_stats { timings }; }
+
+    size_t nodes_expanded = 0;
+    size_t edges_scanned = 0;
+    size_t visited_lookups = 0;
+    size_t peak_frontier = 0;
+    size_t relaxations = 0;
+    size_t passes = 0;
+    bool timings;
+
+    // Seconds spent in each phase, in order of first appearance
+    std::vector<std::pair<const char*, double>> phases;
+
+private:
+    const char* phase_ = nullptr;
+    clock_type::time_point phase_start_;
+};
@@ -0,0 +1,548 @@
+namespace bits
+{
+
+inline size_t lowest(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    size_t idx = 0;
+
+    for (; !(word & 1); word >>= 1)
+    {
+        ++idx;
+    }
+
+    return idx;
+#endif
+}
+
+inline size_t highest(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(word);
+#else
+    size_t idx = 0;
+
+    while (word >>= 1)
+    {
+        ++idx;
+    }
+
+    return idx;
+#endif
+}
+
+} // namespace bits
+
+template <typename T, typename A>
+constexpr const typename tree<T, A>::id_type tree<T, A>::null_id;
+
+template <typename T, typename A>
+inline tree<T, A>::tree(const allocator_type& alloc)
+    : objs_(alloc), parent_(alloc), first_child_(alloc), next_sibling_(alloc), prev_sibling_(alloc), valid_(alloc), free_(alloc)
+{ }
+
+template <typename T, typename A>
+inline typename tree<T, A>::id_type tree<T, A>::insert(
+    typename std::conditional<std::is_arithmetic<value_type>::value, value_type,
+    const value_type&>::type val
+)
+{
+    if (!free_.empty())
+    {
+        id_type node = free_.back();
+        free_.pop_back();
+        objs_[node] = val;
+        valid_[node] = 1;
+
+        return node;
+    }
+
+    objs_.push_back(val);
+    grow(objs_.size());
+
+    return objs_.size() - 1;
+}
+
+template <typename T, typename A>
+template <typename iterator_type>
+inline typename tree<T, A>::id_type tree<T, A>::insert(iterator_type first, iterator_type last)
+{
+    id_type start = objs_.size();
+    objs_.insert(objs_.end(), first, last);
+    grow(objs_.size());
+
+    return start;
+}
+
+template <typename T, typename A>
+inline typename tree<T, A>::size_type tree<T, A>::children_range::size() const
+{
+    size_type n = 0;
+
+    for (id_type node = first_; node != null_id; node = G_.next_sibling(node))
+    {
+        n++;
+    }
+
+    return n;
+}
+
+template <typename T, typename A>
+inline void tree<T, A>::grow(size_type n)
+{
+    parent_.resize(n, null_id);
+    first_child_.resize(n, null_id);
+    next_sibling_.resize(n, null_id);
+    prev_sibling_.resize(n, null_id);
+    valid_.resize(n, 1);
+}
+
+template <typename T, typename A>
+inline void tree<T, A>::reserve(size_type nodes)
+{
+    objs_.reserve(nodes);
+    parent_.reserve(nodes);
+    first_child_.reserve(nodes);
+    next_sibling_.reserve(nodes);
+    prev_sibling_.reserve(nodes);
+    valid_.reserve(nodes);
+}
+
+template <typename T, typename A>
+inline void tree<T, A>::append(id_type node, id_type child)
+{
+    detach(child);
+
+    id_type first = first_child_[node];
+
+    if (first == null_id)
+    {
+        first_child_[node] = child;
+        prev_sibling_[child] = child;
+    }
+    else
+    {
+        id_type last = prev_sibling_[first];
+        next_sibling_[last] = child;
+        prev_sibling_[child] = last;
+        prev_sibling_[first] = child;
+    }
+
+    parent_[child] = node;
+    edges_++;
+}
+
+template <typename T, typename A>
+inline void tree<T, A>::detach(id_type child)
+{
+    id_type node = parent_[child];
+
+    if (node == null_id)
+    {
+        return;
+    }
+
+    id_type first = first_child_[node];
+    id_type next = next_sibling_[child];
+
+    if (child == first)
+    {
+        first_child_[node] = next;
+
+        if (next != null_id)
+        {
+            prev_sibling_[next] = prev_sibling_[child];
+        }
+    }
+    else
+    {
+        id_type prev = prev_sibling_[child];
+        next_sibling_[prev] = next;
+        prev_sibling_[next != null_id ? next : first] = prev;
+    }
+
+    parent_[child] = null_id;
+    next_sibling_[child] = null_id;
+    prev_sibling_[child] = null_id;
+    edges_--;
+}
+
+template <typename T, typename A>
+inline void tree<T, A>::erase(id_type node)
+{
+    if (!is_valid(node))
+    {
+        return;
+    }
+
+    detach(node);
+
+    while (first_child_[node] != null_id)
+    {
+        detach(first_child_[node]);
+    }
+
+    objs_[node] = value_type {};
+    valid_[node] = 0;
+    free_.push_back(node);
+}
+
+template <typename T, typename A>
+inline void tree<T, A>::erase(const std::vector<id_type>& nodes)
+{
+    for (id_type node : nodes)
+    {
+        erase(node);
+    }
+}
+
+template <typename T, typename A>
+inline void tree<T, A>::erase(id_type node, id_type child)
+{
+    if (parent_[child] == node)
+    {
+        detach(child);
+    }
+}
+
+template <typename T, typename A>
+inline typename tree<T, A>::id_type tree<T, A>::next_valid(id_type node) const
+{
+    for (; node < objs_.size(); ++node)
+    {
+        if (valid_[node])
+        {
+            return node;
+        }
+    }
+
+    return null_id;
+}
+
+template <typename T, typename A>
+inline typename tree<T, A>::id_type tree<T, A>::next_child(id_type node) const
+{
+    for (; node < objs_.size(); ++node)
+    {
+        if (parent_[node] != null_id)
+        {
+            return node;
+        }
+    }
+
+    return null_id;
+}
+
+template <typename T, typename A>
+template <typename container_type>
+inline void tree<T, A>::search_iterator<container_type>::reach(id_type node)
+{
+    curr_ = node;
+    pushed_ = 0;
+
+    if (reversed_)
+    {
+        if (G_->parent(node) != null_id)
+        {
+            frontier_.push(G_->parent(node));
+            ++pushed_;
+        }
+    }
+    else
+    {
+        for (id_type child : G_->children(node))
+        {
+            frontier_.push(child);
+            ++pushed_;
+        }
+    }
+
+    drop_pruned();
+}
+
+// Children of pruned nodes that reach the top of a queue frontier are dropped,
+// so that peek() never returns a node the visit won't reach
+template <typename T, typename A>
+template <typename container_type>
+inline void tree<T, A>::search_iterator<container_type>::drop_pruned()
+{
+    while (!pruned_.empty() && !frontier_.empty() && pushed_from(frontier_.top(), pruned_.front().first))
+    {
+        frontier_.pop();
+
+        if (--pruned_.front().second == 0)
+        {
+            pruned_.pop_front();
+        }
+    }
+}
+
+template <typename T, typename A>
+template <typename container_type>
+inline typename tree<T, A>::template search_iterator<container_type>& tree<T, A>::search_iterator<container_type>::operator++()
+{
+    if (frontier_.empty())
+    {
+        curr_ = null_id;
+        pushed_ = 0;
+        return *this;
+    }
+
+    id_type node = frontier_.top();
+    frontier_.pop();
+    reach(node);
+
+    return *this;
+}
+
+// The children of the current node are popped back off when they are on top of
+// the frontier, as in a stack. In a queue they're behind the nodes pushed before
+// them, so they're remembered and dropped once they come up.
+template <typename T, typename A>
+template <typename container_type>
+inline void tree<T, A>::search_iterator<container_type>::prune()
+{
+    while (pushed_ > 0 && pushed_from(frontier_.top(), curr_))
+    {
+        frontier_.pop();
+        --pushed_;
+    }
+
+    if (pushed_ > 0)
+    {
+        pruned_.emplace_back(curr_, pushed_);
+        pushed_ = 0;
+    }
+}
+
+template <typename T, typename A>
+template <typename container_type>
+inline typename tree<T, A>::size_type tree<T, A>::search_iterator<container_type>::operator-(const search_iterator& other) const
+{
+    size_type d = 0;
+
+    for (id_type v = curr_; v != null_id && *other != null_id; v = G_->parent(v), ++d)
+    {
+        if (v == *other)
+        {
+            return d;
+        }
+    }
+
+    return std::numeric_limits<size_type>::max();
+}
+
+template <typename T, typename A>
+template <typename container_type>
+inline typename tree<T, A>::path_array tree<T, A>::search_iterator<container_type>::operator<(const search_iterator& other) const
+{
+    path_array p;
+
+    for (id_type v = curr_; v != null_id && *other != null_id; v = G_->parent(v))
+    {
+        p.push_back(v);
+
+        if (v == *other)
+        {
+            std::reverse(p.begin(), p.end());
+            return p;
+        }
+    }
+
+    return {};
+}
+
+constexpr const tree_index::id_type tree_index::null_id;
+
+template <typename T, typename A>
+inline tree_index::tree_index(const tree<T, A>& G)
+{
+    size_type n = G.capacity();
+
+    pre_.assign(n, null_id);
+    size_.assign(n, 0);
+    depth_.assign(n, 0);
+    order_.reserve(G.order());
+    parents_.reserve(G.order());
+
+    // Preorder without a stack: down to the first child, else to the next sibling
+    // of the closest ancestor that has one
+    for (auto it = G.nodes_begin(); it != G.nodes_end(); ++it)
+    {
+        if (!G.is_root(*it))
+        {
+            continue;
+        }
+
+        id_type root = *it;
+        id_type node = root;
+
+        while (true)
+        {
+            id_type parent = G.parent(node);
+
+            pre_[node] = order_.size();
+            depth_[node] = node == root ? 0 : depth_[parent] + 1;
+            order_.push_back(node);
+            parents_.push_back(node == root ? 0 : pre_[parent] + 1);
+
+            if (G.first_child(node) != null_id)
+            {
+                node = G.first_child(node);
+                continue;
+            }
+
+            while (node != root && G.next_sibling(node) == null_id)
+            {
+                node = G.parent(node);
+            }
+
+            if (node == root)
+            {
+                break;
+            }
+
+            node = G.next_sibling(node);
+        }
+    }
+
+    size_type m = order_.size();
+    size_type max_depth = 0;
+
+    for (size_type k = m; k-- > 0;)
+    {
+        id_type node = order_[k];
+        size_[node]++;
+        max_depth = std::max(max_depth, depth_[node]);
+
+        if (parents_[k] > 0)
+        {
+            size_[order_[parents_[k] - 1]] += size_[node];
+        }
+    }
+
+    levels_.assign(max_depth + 2, 0);
+
+    for (id_type node : order_)
+    {
+        levels_[depth_[node] + 1]++;
+    }
+
+    for (size_type d = 1; d < levels_.size(); ++d)
+    {
+        levels_[d] += levels_[d - 1];
+    }
+
+    by_level_.resize(m);
+    std::vector<size_type> next(levels_.begin(), levels_.end() - 1);
+
+    for (size_type k = 0; k < m; ++k)
+    {
+        by_level_[next[depth_[order_[k]]]++] = k;
+    }
+
+    // masks_[k] has a bit for every position of the block, up to k, that is the minimum
+    // from there to k: a monotonic stack, where the lowest bit is the minimum of the block so far
+    masks_.resize(m);
+    uint64_t stack = 0;
+
+    for (size_type k = 0; k < m; ++k)
+    {
+        size_type start = k / 64 * 64;
+
+        if (k == start)
+        {
+            stack = 0;
+        }
+
+        while (stack != 0 && parents_[start + bits::highest(stack)] >= parents_[k])
+        {
+            stack &= ~(uint64_t { 1 } << bits::highest(stack));
+        }
+
+        stack |= uint64_t { 1 } << (k - start);
+        masks_[k] = stack;
+    }
+
+    size_type count = (m + 63) / 64;
+    blocks_.assign(1, std::vector<size_type>(count));
+
+    for (size_type b = 0; b < count; ++b)
+    {
+        blocks_[0][b] = min_in_block(b * 64, std::min(m, b * 64 + 64) - 1);
+    }
+
+    for (size_type len = 2; len <= count; len *= 2)
+    {
+        const std::vector<size_type>& prev = blocks_.back();
+        std::vector<size_type> level(count - len + 1);
+
+        for (size_type b = 0; b + len <= count; ++b)
+        {
+            level[b] = std::min(prev[b], prev[b + len / 2]);
+        }
+
+        blocks_.push_back(std::move(level));
+    }
+}
+
+inline tree_index::size_type tree_index::min_in_block(size_type first, size_type last) const
+{
+    uint64_t mask = masks_[last] & (~uint64_t { 0 } << (first % 64));
+    return parents_[last / 64 * 64 + bits::lowest(mask)];
+}
+
+inline tree_index::size_type tree_index::min_parent(size_type first, size_type last) const
+{
+    size_type fb = first / 64;
+    size_type lb = last / 64;
+
+    if (fb == lb)
+    {
+        return min_in_block(first, last);
+    }
+
+    size_type best = std::min(min_in_block(first, fb * 64 + 63), min_in_block(lb * 64, last));
+
+    if (fb + 1 < lb)
+    {
+        size_type level = bits::highest(lb - fb - 1);
+        const std::vector<size_type>& table = blocks_[level];
+        best = std::min(best, std::min(table[fb + 1], table[lb - (size_type { 1 } << level)]));
+    }
+
+    return best;
+}
+
+inline tree_index::id_type tree_index::lca(id_type u, id_type v) const
+{
+    if (u == v)
+    {
+        return u;
+    }
+
+    size_type first = std::min(pre_[u], pre_[v]);
+    size_type last = std::max(pre_[u], pre_[v]);
+
+    // Past the first node, the shallowest parent in the range is the lowest common ancestor
+    size_type p = min_parent(first + 1, last);
+
+    return p == 0 ? null_id : order_[p - 1];
+}
+
+inline tree_index::id_type tree_index::level_ancestor(id_type node, size_type k) const
+{
+    if (k > depth_[node])
+    {
+        return null_id;
+    }
+
+    size_type d = depth_[node] - k;
+    auto first = by_level_.begin() + levels_[d];
+    auto last = by_level_.begin() + levels_[d + 1];
+
+    // The ancestor is the last node at that depth coming before node in preorder
+    return order_[*(std::upper_bound(first, last, pre_[node]) - 1)];
+}
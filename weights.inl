@@ -0,0 +1,103 @@
+// Stands for the weights of the edges of a node in an unweighted graph. It has the
+// interface of the vector it replaces, but stores nothing: every weight reads 1.
+template <typename W>
+class unit_weights
+{
+public:
+    using value_type = W;
+
+    struct reference
+    {
+        reference& operator=(W) { return *this; }
+        operator W() const { return 1; }
+    };
+
+    struct iterator
+    {
+        iterator operator+(ptrdiff_t) const { return *this; }
+    };
+
+public:
+    unit_weights() = default;
+
+    template <typename B>
+    explicit unit_weights(const B&)
+    { }
+
+public:
+    reference operator[](size_t) const { return {}; }
+    iterator begin() const { return {}; }
+    iterator end() const { return {}; }
+    W* data() const { return nullptr; }
+    size_t size() const { return 0; }
+    size_t capacity() const { return 0; }
+
+    void push_back(W) { }
+    void reserve(size_t) { }
+    void resize(size_t) { }
+    void erase(iterator) { }
+    void clear() { }
+    void swap(unit_weights&) { }
+};
+
+// Same, for the weights of all the nodes.
+template <typename W>
+class unit_weights_table
+{
+public:
+    using value_type = unit_weights<W>;
+    using iterator = typename unit_weights<W>::iterator;
+
+public:
+    unit_weights_table() = default;
+
+    template <typename B>
+    explicit unit_weights_table(const B&)
+    { }
+
+    template <typename B>
+    unit_weights_table(size_t, const unit_weights<W>&, const B&)
+    { }
+
+public:
+    unit_weights<W>& operator[](size_t) { return unit_; }
+    const unit_weights<W>& operator[](size_t) const { return unit_; }
+    iterator begin() const { return {}; }
+    iterator end() const { return {}; }
+    size_t size() const { return 0; }
+    size_t capacity() const { return 0; }
+
+    template <typename... Args>
+    void emplace_back(Args&&...) { }
+
+    void resize(size_t, const unit_weights<W>& = {}) { }
+    void reserve(size_t) { }
+    void erase(iterator, iterator) { }
+    void clear() { }
+    void swap(unit_weights_table&) { }
+
+private:
+    unit_weights<W> unit_;
+};
+
+// How a graph stores its weights. V = void makes it unweighted: nothing is stored,
+// every edge weighs 1, and distances are counted in hops, as ssize_t.
+template <typename V, typename A>
+struct weight_storage
+{
+    using weight_type = V;
+    using weights_container = std::vector<V, typename std::allocator_traits<A>::template rebind_alloc<V>>;
+    using table_type = std::vector<weights_container, typename std::allocator_traits<A>::template rebind_alloc<weights_container>>;
+
+    static constexpr bool stored = true;
+};
+
+template <typename A>
+struct weight_storage<void, A>
+{
+    using weight_type = ssize_t;
+    using weights_container = unit_weights<ssize_t>;
+    using table_type = unit_weights_table<ssize_t>;
+
+    static constexpr bool stored = false;
+};